@@ -2415,6 +2415,26 @@ if test "$sfs_cv_epoll" = yes; then
 	     Define if this machine has Linux epoll support)
 fi])
 dnl
+dnl SFS_IO_URING
+dnl
+dnl  Linux io_uring, driven through raw system calls; we need
+dnl  IORING_ENTER_EXT_ARG, which is Linux 5.11 or later.
+dnl
+AC_DEFUN([SFS_IO_URING],
+[AC_CACHE_CHECK(for io_uring, sfs_cv_io_uring,
+AC_TRY_COMPILE([
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+], [
+   struct io_uring_getevents_arg arg;
+   int n = __NR_io_uring_setup + __NR_io_uring_enter;
+   int f = IORING_ENTER_EXT_ARG | IORING_FEAT_EXT_ARG;
+], sfs_cv_io_uring=yes, sfs_cv_io_uring=no))
+if test "$sfs_cv_io_uring" = yes; then
+	AC_DEFINE(HAVE_IO_URING, 1,
+	     Define if this machine has Linux io_uring support)
+fi])
+dnl
 dnl SFS_KQUEUE
 dnl
 dnl
@@ -2432,6 +2452,53 @@ if test "$sfs_cv_kqueue" = yes; then
 	     Define if this machine has FreeBSD kqueue support)
 fi])
 dnl
+dnl SFS_MTCORE
+dnl
+dnl  Multi-core mode for the event loop (async/sfs_mtcore.h): needs
+dnl  pthreads and thread-local storage; uses eventfd where available.
+dnl
+AC_DEFUN([SFS_MTCORE],
+[AC_ARG_ENABLE(mtcore,
+--enable-mtcore           run one event loop per thread (async/sfs_mtcore.h))
+AC_CACHE_CHECK(for eventfd, sfs_cv_eventfd,
+AC_TRY_COMPILE([
+#include <sys/eventfd.h>
+], [
+   (void)eventfd (0, 0);
+], sfs_cv_eventfd=yes, sfs_cv_eventfd=no))
+if test "$sfs_cv_eventfd" = yes; then
+	AC_DEFINE(HAVE_EVENTFD, 1,
+	     Define if this machine has Linux eventfd support)
+fi
+if test "${enable_mtcore+set}" = "set" -a "$enable_mtcore" != "no"
+then
+    AC_CACHE_CHECK(for thread-local storage, sfs_cv_tls,
+    AC_TRY_COMPILE([], [
+       static __thread int x;
+       x = 1;
+    ], sfs_cv_tls=yes, sfs_cv_tls=no))
+    if test "$sfs_cv_tls" != yes; then
+	AC_MSG_ERROR("--enable-mtcore needs compiler support for __thread")
+    fi
+    AC_CACHE_CHECK(for -lpthread, sfs_cv_mtcore_libpthread,
+    [
+      libs_save=$LIBS
+      LIBS="-lpthread"
+      AC_TRY_LINK([#include <pthread.h>
+                  ], [ pthread_create (0, 0, 0, 0); ],
+                  sfs_cv_mtcore_libpthread="-lpthread",
+		  sfs_cv_mtcore_libpthread=no)
+      LIBS=$libs_save
+    ])
+    if test "$sfs_cv_mtcore_libpthread" = no; then
+	AC_MSG_ERROR("--enable-mtcore needs pthreads")
+    fi
+    LDADD_STD_ALL="$LDADD_STD_ALL $sfs_cv_mtcore_libpthread"
+    AC_DEFINE(HAVE_SFS_MTCORE, 1,
+	Define to run one event loop per thread (async/sfs_mtcore.h))
+fi
+])
+dnl
 dnl SFS_INIT_LDVERSION
 dnl
 AC_DEFUN([SFS_INIT_LDVERSION],
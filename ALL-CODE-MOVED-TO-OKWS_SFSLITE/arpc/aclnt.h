@@ -32,8 +32,24 @@ typedef callback<void, clnt_stat, const char *, ssize_t>::ref aclntraw_cb;
 typedef callback<void, ptr<aclnt>, clnt_stat>::ref aclntalloc_cb;
 typedef callback<ptr<axprt_stream>, int>::ref axprtalloc_fn;
 extern aclnt_cb aclnt_cb_null;
+/* Where new xids come from.  The default is safe on every loop of a
+ * multi-core program (sfs_mtcore.h); a replacement must be too. */
 extern u_int32_t (*next_xid) ();
 
+/* Call objects, and the copies of messages that rpccb_msgbufs keep
+ * for retransmission, come from a per-thread pool of small blocks
+ * instead of going back to malloc after every call.  These are the
+ * calling thread's counters. */
+struct aclnt_pool_stats {
+  u_int64_t hits;		// allocations served from the pool
+  u_int64_t misses;		// allocations that had to go to malloc
+  u_int64_t drops;		// frees that went to free, pool being full
+  size_t bytes_cached;		// bytes now sitting in the pool
+};
+void aclnt_getpoolstats (aclnt_pool_stats *);
+void aclnt_trimpool ();		// give the calling thread's pool back
+void *aclnt_poolalloc (size_t);
+void aclnt_poolfree (void *, size_t);
 
 class callbase {
   friend class aclnt;
@@ -61,6 +77,59 @@ public:
   void timeout (time_t sec, long nsec = 0);
   void cancel () { delete this; }
   virtual void finish (clnt_stat) = 0;
+
+#if !defined (DMALLOC) && !defined (SIMPLE_LEAK_CHECKER)
+  static void *operator new (size_t n) { return aclnt_poolalloc (n); }
+  static void operator delete (void *p, size_t n) { aclnt_poolfree (p, n); }
+#endif /* !DMALLOC && !SIMPLE_LEAK_CHECKER */
+};
+
+/* Outstanding calls on a transport, by XID.  With a ring (setring),
+ * genxid hands out XIDs whose low bits pick a free slot in an array,
+ * so replies find their calls without hashing.  Calls that don't fit,
+ * because the ring was full or the XID came with the message, go in a
+ * hash table instead. */
+class xidtab_t {
+  ihash<const u_int32_t, callbase, &callbase::xid, &callbase::hlink> tab;
+  callbase **ring;
+  u_int32_t ringmask;
+  u_int32_t ringpos;
+  u_int nringbits;
+
+  xidtab_t (const xidtab_t &);
+  xidtab_t &operator= (const xidtab_t &);
+
+public:
+  enum { maxringbits = 16 };
+  enum { maxprobe = 4 };	// ring slots genxid tries before giving up
+
+  xidtab_t () : ring (NULL), ringmask (0), ringpos (0), nringbits (0) {}
+  ~xidtab_t () { xfree (ring); }
+
+  callbase *operator[] (u_int32_t xid) const {
+    if (ring) {
+      callbase *cb = ring[xid & ringmask];
+      if (cb && cb->xid == xid)
+	return cb;
+    }
+    return tab[xid];
+  }
+  void insert (callbase *cb) {
+    if (ring && !ring[cb->xid & ringmask])
+      ring[cb->xid & ringmask] = cb;
+    else
+      tab.insert (cb);
+  }
+  void remove (callbase *cb) {
+    if (ring && ring[cb->xid & ringmask] == cb)
+      ring[cb->xid & ringmask] = NULL;
+    else
+      tab.remove (cb);
+  }
+
+  u_int32_t genxid (u_int32_t (*rnd) ());
+  void setring (u_int nbits);	// 0 for no ring
+  u_int ringbits () const { return nringbits; }
 };
 
 class rpccb : public callbase {
@@ -87,16 +156,24 @@ protected:
   rpccb_msgbuf (ref<aclnt> c, xdrsuio &x, aclnt_cb cb,
 		void *out, sfs::xdrproc_t outproc, const sockaddr *d)
     : rpccb (c, x, cb, out, outproc, d) {
-    msglen = x.uio ()->resid ();
-    msgbuf = suio_flatten (x.uio ());
+    msgpooled = msglen = x.uio ()->resid ();
+    msgbuf = aclnt_poolalloc (msglen);
+    x.uio ()->copyout (static_cast<char *> (msgbuf));
   }
   rpccb_msgbuf (ref<aclnt> c, char *buf, size_t len, aclnt_cb cb,
 		void *out, sfs::xdrproc_t outproc, const sockaddr *d)
     : rpccb (c, getxid (c, buf, len), cb, out, outproc, d),
-      msgbuf (buf), msglen (len) {}
-  ~rpccb_msgbuf () { xfree (msgbuf); }
+      msgpooled (0), msgbuf (buf), msglen (len) {}
+  ~rpccb_msgbuf () {
+    if (msgpooled)
+      aclnt_poolfree (msgbuf, msgpooled);
+    else
+      xfree (msgbuf);
+  }
   virtual callbase *init (xdrsuio &x) { return this; }
 
+  size_t msgpooled;		// size of msgbuf if it's from the pool
+
 public:
   void *msgbuf;
   size_t msglen;
@@ -217,6 +294,10 @@ public:
 
   void seteofcb (cbv::ptr);
 
+  // Look calls up in a ring of 2^nbits slots (see xidtab_t); this is
+  // per transport, so it affects every aclnt on xprt ().
+  void set_xidring (u_int nbits);
+
   void set_send_hook (cbv::ptr cb) { send_hook = cb; }
   void set_recv_hook (cbv::ptr cb) { recv_hook = cb; }
 
@@ -89,6 +89,8 @@ public:
 
 class xhinfo;
 
+#include "rcvbuf.h"
+#include "replycache.h"
 #include "axprt.h"
 #include "aclnt.h"
 #include "asrv.h"
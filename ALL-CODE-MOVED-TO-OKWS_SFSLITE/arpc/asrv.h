@@ -23,6 +23,7 @@
  */
 
 class asrv;
+namespace rpc_stats { class histogram_t; }
 
 struct progvers {
   const u_int32_t prog;
@@ -57,10 +58,16 @@ class svccb {
 
   timespec ts_start;            // keep track of when it started
 
+  ptr<rcvpkt> pkt;              // Call message, if the transport lends it
+
+  arena argarena;		// Holds arg, with asrv::set_arena_decode
+  bool arenaarg;
+
   svccb (const svccb &);	// No copying
   const svccb &operator= (const svccb &);
 
   void init (asrv *, const sockaddr *);
+  void delarg ();
 
   u_int32_t m_rpcvers;
 
@@ -95,6 +102,11 @@ public:
   void *getvoidres ();
   template<class T> T *getres () { return static_cast<T *> (getvoidres ()); }
 
+  /* Scratch memory freed along with the arguments, after the reply
+   * has gone out.  Handy as rpc_vec::set storage for results made of
+   * plain data, which then costs no allocation of its own. */
+  arena &getarena () { return argarena; }
+
   const opaque_auth *getcred () const { return &msg.rm_call.cb_cred; }
   const opaque_auth *getverf () const { return &msg.rm_call.cb_verf; }
   const authunix_parms *getaup () const;
@@ -102,6 +114,11 @@ public:
   const sockaddr *getsa () const { return addr; }
   bool fromresvport () const;
 
+  /* The call message as received, when the transport can hand out a
+   * reference to it (axprt_pipe::set_rcvbuf); otherwise NULL.  Holding
+   * on to it keeps the arguments' bytes in place without a copy. */
+  const ptr<rcvpkt> &getpkt () const { return pkt; }
+
   void reply (const void *, sfs::xdrproc_t = NULL, bool nocache = false);
   template<class T> void replyref (const T &res, bool nocache = false)
     { reply (&res, NULL, nocache); }
@@ -128,6 +145,8 @@ private:
   asrv_cb::ptr cb;
 
   cbv::ptr recv_hook;
+  rpc_stats::histogram_t *lathist;
+  bool arenadecode;
 
   static void seteof (ref<xhinfo>, const sockaddr *, bool force = false);
 
@@ -154,6 +173,23 @@ public:
 
   void set_recv_hook (cbv::ptr cb) { recv_hook = cb; }
 
+  // Latency histograms per procedure for this server alone, on top of
+  // the process-wide ones in rpc_stats.h.  Off by default, since they
+  // take a few KB per procedure.
+  void set_latency_hist (bool on);
+  const rpc_stats::histogram_t *latency_hist (u_int32_t proc) const;
+
+  // Decode each call's arguments into an arena that goes away in one
+  // piece once the reply is sent, instead of allocating every rpc_ptr
+  // and rpc_vec separately (see xdr_setarena).  Opaque data points
+  // into the call message when the transport lends it (see
+  // svccb::getpkt).  Handlers must then leave the arguments' pointers
+  // and vectors alone, and copy out whatever they keep past the reply.
+  void set_arena_decode (bool on) { arenadecode = on; }
+
+  // The duplicate request cache, on unreliable transports only.
+  virtual replycache *get_replycache () { return NULL; }
+
   static void dispatch (ref<xhinfo>, const char *, ssize_t, const sockaddr *);
 
   static ptr<asrv> alloc (ref<axprt>, const rpc_program &,
@@ -214,16 +250,20 @@ public:
   void setcb (asrv_cb::ptr cb);
 };
 
-class asrv_unreliable : public asrv_replay {
-  const u_int maxrsize;
+class asrv_unreliable : public asrv {
+  replycache rc;
 
+  static replykey key (const svccb *sbp);
   bool isreplay (svccb *sbp);
   void sendreply (svccb *sbp, xdrsuio *, bool nocache);
 
 protected:
-  asrv_unreliable (ref<xhinfo> x, const rpc_program &rp,
-		   asrv_cb::ptr cb, u_int rs = 16)
-    : asrv_replay (x, rp, cb), maxrsize (rs) {}
+  asrv_unreliable (ref<xhinfo> x, const rpc_program &rp, asrv_cb::ptr cb,
+		   size_t maxbytes = replycache::defmaxbytes)
+    : asrv (x, rp, cb), rc (maxbytes) {}
+
+public:
+  replycache *get_replycache () { return &rc; }
 };
 
 class asrv_resumable : public asrv_replay {
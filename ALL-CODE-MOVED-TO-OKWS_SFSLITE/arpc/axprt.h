@@ -53,6 +53,10 @@ public:
   virtual void poll () = 0;
   virtual int getreadfd () = 0;
   virtual int getwritefd () = 0;
+
+  // From within the receive callback, a reference to the packet being
+  // delivered, for transports that can hand one out (see rcvbuf.h).
+  virtual ptr<rcvpkt> curpkt () { return NULL; }
   
   void send (const void *data, size_t len, const sockaddr *dest) {
     iovec iov = {(char *) data, len};
@@ -94,6 +98,42 @@ class axprt_pipe : public axprt {
   vec<u_int64_t> syncpts;
   int sndbufsz;
 
+  struct uring_op_t;
+  bool _uring;
+  uring_op_t *_urd;
+  uring_op_t *_uwr;
+  char *_urbuf;
+
+  void uring_input ();
+  void uring_input_done (char *buf, ssize_t n);
+  void uring_output ();
+  void uring_output_done (ssize_t n);
+  void uring_detach ();
+  static void uring_input_cb (uring_op_t *op, ssize_t n);
+  static void uring_output_cb (uring_op_t *op, ssize_t n);
+
+  bool _rcvbuf;
+  ptr<rcvbuf> _rb;        // buffer being read into
+  size_t _rbpos;          // start of what's not yet cut into packets
+  size_t _rblen;          // end of what's been read
+  ptr<rcvpkt> _rpkt;      // packet being put together
+  size_t _rneed;          // bytes still missing from _rpkt
+  ptr<rcvpkt> _curpkt;    // packet being delivered
+  ptr<rcvbuf> _flatbuf;   // where the last chained packet was flattened
+
+  void rcv_reserve ();
+  void rcv_input ();
+  void rcv_parse ();
+
+  bool _cork;
+  size_t _corkmax;
+  yieldcb_t *_corkcb;     // end of the iteration, if anything was sent
+  u_int64_t _nwritev;
+  u_int64_t _nwritev_bytes;
+  u_int64_t _ncorked;
+
+  void uncork ();
+
 protected:
   const size_t pktsize;
   const size_t bufsize;
@@ -119,12 +159,15 @@ protected:
   virtual int dowritev (int iovcnt) { return out->output (fdwrite, iovcnt); }
   virtual void recvbreak ();
   virtual bool getpkt (char **, char *);
+  virtual bool uring_capable () const { return true; }
+  virtual bool rcvbuf_capable () const { return true; }
 
   void _sockcheck(int fd);
   void fail ();
   void input ();
   void callgetpkt ();
   void output ();
+  void sendout ();
   
   axprt_pipe (int rfd, int wfd, size_t ps, size_t bufsize = 0);
   virtual ~axprt_pipe ();
@@ -145,6 +188,34 @@ public:
   void set_fail_on_oversized_packet (bool b) { _foosp = b; }
   bool fail_on_oversized_packet () const { return _foosp; }
 
+  // Under SELECT_URING, do reads and writes through the loop's
+  // io_uring (sfs_select.h) rather than read and writev.  Returns
+  // false if that's not possible.  Don't use with reclaim (), since
+  // the kernel may be holding on to a read.
+  bool set_uring (bool b);
+  bool uring () const { return _uring; }
+
+  // Read into pooled rcvbufs and cut packets out of them in place;
+  // see rcvbuf.h.  Returns false if the transport can't.
+  bool set_rcvbuf (bool b);
+  bool rcvbuf_mode () const { return _rcvbuf; }
+  ptr<rcvpkt> curpkt () { return _curpkt; }
+
+  // Cork mode: the first packet sent in an iteration of the event
+  // loop goes out right away, but any more are held back and written
+  // together at the end of the iteration, or as soon as maxbytes of
+  // them are waiting.  Pays off for servers answering many pipelined
+  // calls at once.
+  enum { defcork = 0x10000 };
+  void set_cork (bool b, size_t maxbytes = defcork);
+  bool cork () const { return _cork; }
+
+  // Calls to writev that wrote anything, the bytes they wrote, and
+  // packets held back by cork mode.
+  u_int64_t nwritev () const { return _nwritev; }
+  u_int64_t nwritev_bytes () const { return _nwritev_bytes; }
+  u_int64_t ncorked () const { return _ncorked; }
+
   u_int64_t get_raw_bytes_sent () const { return raw_bytes_sent; }
   int sndbufsize () const { return sndbufsz; }
 
@@ -179,6 +250,9 @@ class axprt_clone : public axprt_stream {
 protected:
   axprt_clone (int f, size_t ps) : axprt_stream (f, ps) {}
   virtual ssize_t doread (void *buf, size_t maxsz);
+  virtual bool uring_capable () const { return false; }
+  // doread and extract work on pktbuf, which rcvbuf mode doesn't use.
+  virtual bool rcvbuf_capable () const { return false; }
 public:
   void extract (int *fdp, str *datap);
   static ref<axprt_clone> alloc (int f, size_t ps = defps)
@@ -206,6 +280,7 @@ protected:
   virtual void recvbreak ();
   virtual ssize_t doread (void *buf, size_t maxsz);
   virtual int dowritev (int iovcnt);
+  virtual bool uring_capable () const { return false; }
 
 public:
   bool allow_recvfd;
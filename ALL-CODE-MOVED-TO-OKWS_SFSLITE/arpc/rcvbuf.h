@@ -0,0 +1,88 @@
+// -*-c++-*-
+/* $Id$ */
+
+/*
+ *
+ * Copyright (C) 1998 David Mazieres (dm@uun.org)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ * USA
+ *
+ */
+
+//
+// Receive buffers for stream transports (axprt_pipe::set_rcvbuf).
+// The transport reads into fixed-size, pooled rcvbufs and cuts the
+// packets it finds there into rcvpkts, which point into the buffers
+// and hold references to them.  A packet that arrived within one
+// buffer is handed out in place; a longer one is a chain of pieces
+// until someone asks for it contiguous.  Buffers go back to the pool
+// once the transport and every packet cut from them have let go, so
+// a packet kept around pins its whole buffer.  Each transport keeps
+// the buffer of its last flattened packet, to flatten the next one
+// into if the last one has been let go.
+//
+
+class rcvbuf : public virtual refcount {
+  char *const _base;
+  const size_t _size;
+  rcvbuf *_next;
+
+  rcvbuf (const rcvbuf &);
+  rcvbuf &operator= (const rcvbuf &);
+
+protected:
+  rcvbuf (size_t size);
+  virtual ~rcvbuf ();
+
+public:
+  enum { defsize = 0x10000 };
+  enum { maxfree = 0x100 };
+
+  char *base () const { return _base; }
+  size_t size () const { return _size; }
+  bool shared () const { return refcount_getcnt () > 1; }
+
+  static ref<rcvbuf> alloc (size_t size = defsize);
+  void finalize ();
+};
+
+class rcvpkt {
+public:
+  struct piece {
+    ref<rcvbuf> buf;
+    const char *base;
+    size_t len;
+    piece (const ref<rcvbuf> &b, const char *p, size_t l)
+      : buf (b), base (p), len (l) {}
+  };
+
+private:
+  vec<piece, 1> _pieces;
+  size_t _len;
+
+public:
+  rcvpkt () : _len (0) {}
+
+  size_t len () const { return _len; }
+  size_t npieces () const { return _pieces.size (); }
+  const piece &operator[] (size_t i) const { return _pieces[i]; }
+
+  void append (const ref<rcvbuf> &b, const char *p, size_t len);
+  // Copies a chained packet into one buffer.  With spare, the copy
+  // goes into *spare when nobody else holds it and it is big enough,
+  // and otherwise into a new buffer that then becomes *spare.
+  const char *flatten (ptr<rcvbuf> *spare = NULL);
+};
@@ -0,0 +1,103 @@
+// -*-c++-*-
+/* $Id$ */
+
+/*
+ *
+ * Copyright (C) 1998 David Mazieres (dm@uun.org)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ * USA
+ *
+ */
+
+//
+// The duplicate request cache behind servers on unreliable
+// transports (asrv_unreliable).  A call is known by its xid, client
+// address, program, version and procedure.  While it's being served
+// its entry is pending, and retransmissions are dropped; once it's
+// answered, the entry holds the marshaled reply for retransmissions
+// to get back.  Answered entries go oldest first whenever the cache
+// is over its byte budget, which counts each entry's reply, address
+// and bookkeeping.  Pending entries only go when their call does.
+//
+
+struct replycache_stats {
+  u_int64_t hits;		// Retransmissions answered from the cache
+  u_int64_t inprogress;		// Retransmissions of calls still pending
+  u_int64_t misses;		// New calls
+  u_int64_t evictions;
+  size_t entries;
+  size_t bytes;
+};
+
+struct replykey {
+  u_int32_t xid;
+  u_int32_t prog;
+  u_int32_t vers;
+  u_int32_t proc;
+  const sockaddr *addr;		// NULL on a connected transport
+  size_t addrlen;
+
+  operator hash_t () const { return xid ^ hash_bytes (addr, addrlen); }
+  bool operator== (const replykey &k) const {
+    return xid == k.xid && prog == k.prog && vers == k.vers
+      && proc == k.proc && addrlen == k.addrlen
+      && !memcmp (addr, k.addr, addrlen);
+  }
+};
+
+class replycache {
+public:
+  struct entry {
+    replykey key;		// key.addr points just past the entry
+    ihash_entry<entry> hlink;
+    tailq_entry<entry> qlink;
+    char *res;			// NULL while pending
+    size_t reslen;
+  };
+
+private:
+  ihash<replykey, entry, &entry::key, &entry::hlink> tab;
+  tailq<entry, &entry::qlink> answered;	// Oldest first
+  size_t maxbytes;
+  replycache_stats stats;
+
+  static size_t entrysize (const entry *e)
+    { return sizeof (*e) + e->key.addrlen + e->reslen; }
+  void del (entry *e);
+  void trim ();
+
+  replycache (const replycache &);
+  replycache &operator= (const replycache &);
+
+public:
+  enum { defmaxbytes = 0x40000 };
+
+  explicit replycache (size_t max = defmaxbytes);
+  ~replycache ();
+
+  // Returns the entry for a retransmitted call, or NULL after adding
+  // a pending entry for a new one.
+  const entry *lookup (const replykey &k);
+  // Stores the reply to a pending call; res must come from xmalloc,
+  // and the cache frees it.
+  void setreply (const replykey &k, char *res, size_t reslen);
+  // Forgets a call, for one that won't be answered or cached.
+  void remove (const replykey &k);
+
+  void setmaxbytes (size_t max) { maxbytes = max; trim (); }
+  size_t getmaxbytes () const { return maxbytes; }
+  const replycache_stats &getstats () const { return stats; }
+};
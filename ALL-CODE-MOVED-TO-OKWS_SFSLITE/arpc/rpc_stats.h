@@ -34,6 +34,7 @@
 #include <time.h>
 #include "qhash.h"
 #include "str.h"
+#include "msb.h"
 
 class svccb;
 
@@ -80,6 +81,78 @@ template<> struct equals<rpc_stat_proc_t> {
 
 namespace rpc_stats {
 
+/** HDR-style log-linear histogram of latencies in microseconds.  Values
+ * below 2*nsub get a bucket each; above that, every power of two is
+ * split into nsub buckets, so a value is never off by more than 1/nsub
+ * of itself.  Values past the last bucket land in it.  Fixed size, so
+ * adding a value never allocates. */
+  class histogram_t {
+  public:
+    enum { subbits = 4, nsub = 1 << subbits };
+    enum { maxshift = 36 };
+    enum { nbuckets = nsub * (maxshift + 2) };
+
+    histogram_t () { clear (); }
+    void clear ();
+
+    void add (u_int64_t v) {
+      m_counts[bucket (v)]++;
+      m_count++;
+      m_sum += v;
+      if (v > m_max)
+	m_max = v;
+    }
+    void merge (const histogram_t &h);
+    /** add and merge for a histogram that one thread adds to while
+     * others merge it; each word is read and written whole, so a
+     * merge sees every add that came before it and maybe part of one
+     * under way. */
+    void add_shared (u_int64_t v);
+    void merge_shared (const histogram_t &h);
+    /** What was added since h, an earlier copy of this histogram.  The
+     * max becomes the top of the highest bucket still in use. */
+    void subtract (const histogram_t &h);
+
+    u_int64_t count () const { return m_count; }
+    u_int64_t sum () const { return m_sum; }
+    u_int64_t max () const { return m_max; }
+    u_int64_t operator[] (size_t i) const { return m_counts[i]; }
+    /** The value below which a fraction p of the values fall, rounded
+     * up to the top of its bucket. */
+    u_int64_t percentile (double p) const;
+
+    static size_t bucket (u_int64_t v) {
+      if (v < 2 * nsub)
+	return v;
+      size_t shift = fls64 (v) - 1 - subbits;
+      if (shift > maxshift)
+	return nbuckets - 1;
+      return nsub * shift + (v >> shift);
+    }
+    static u_int64_t bucket_lo (size_t i) {
+      if (i < 2 * nsub)
+	return i;
+      size_t shift = i / nsub - 1;
+      return u_int64_t (i % nsub + nsub) << shift;
+    }
+    static u_int64_t bucket_hi (size_t i) {
+      if (i < 2 * nsub)
+	return i;
+      return bucket_lo (i) + (u_int64_t (1) << (i / nsub - 1)) - 1;
+    }
+
+  private:
+    u_int64_t m_counts[nbuckets];
+    u_int64_t m_count;
+    u_int64_t m_sum;
+    u_int64_t m_max;
+  };
+
+  struct hist_table_t;
+
+  /** Microseconds from strt to the loop's current timestamp. */
+  u_int64_t elapsed_usec (const timespec &strt);
+
 /** Collects time to process and call frequency for RPC handling code. The 
  * data is printed out periodically in a machine parseable format. The point is
  * to identify RPCs which take too long or are called to often. */
@@ -105,12 +178,40 @@ namespace rpc_stats {
     /** Call this at the end of an RPC handler */
     void end_call(svccb *call_obj, const timespec &strt);
 
+    /** Keep a latency histogram per procedure.  Each thread fills in
+     * its own, without allocation once a procedure has been seen, and
+     * under a lock that only a dump contends for; they are combined on
+     * dump. */
+    rpc_stat_collector_t &set_histograms (bool on)
+    { m_hist = on; return (*this); }
+    bool histograms () const { return m_hist; }
+
+    /** Print the histograms to out, one procedure per line:
+     *
+     *   prog vers proc count sum p50 p90 p99 p999 max | lo:n lo:n ...
+     *
+     * with latencies in microseconds and one lo:n for each bucket in
+     * use (lo being the smallest value it takes).  A cumulative dump
+     * covers everything since the start; an interval dump covers
+     * what's happened since the previous interval dump. */
+    void dump_hist (strbuf &out, bool interval);
+
+    /** Serve dump_hist on a unix socket at path, from the calling
+     * loop.  A client writes "cumulative" or "interval" (or nothing,
+     * meaning cumulative) and a newline, and reads until EOF.
+     * Returns false if the socket can't be set up. */
+    bool listen_hist (const str &path);
+
   protected:
     bool m_active;
     u_int32_t m_interval;
     timespec m_last_print;
     size_t m_n_per_line;
     qhash<rpc_proc_t, rpc_stats_t> m_stats;
+    bool m_hist;
+    qhash<rpc_proc_t, histogram_t> m_hist_last;
+    timespec m_hist_start;
+    timespec m_hist_last_ts;
 
     void output_line (size_t i, const strbuf &p, strbuf &l, bool frc);
   };
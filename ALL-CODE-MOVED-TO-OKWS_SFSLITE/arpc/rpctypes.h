@@ -182,6 +182,8 @@ public:
   }
   template<size_t m> rpc_vec &set (const ::vec<T, m> &v)
     { set (v.base (), v.size ()); return *this; }
+  // True after set (): the elements belong to someone else.
+  bool borrowed () const { return nofree; }
 
   void reserve (size_t m) { ensure (m); super::reserve (m); }
 
@@ -82,6 +82,7 @@ namespace sfs {
 }
 #include "rpctypes.h"
 #include "extensible_arpc.h"
+#include "arena.h"
 
 #ifdef __APPLE__
 # define XDROPS_KNRPROTO 1
@@ -293,6 +294,355 @@ rpc_traverse (XDR *xdrs, str &obj, RPC_FIELD)
   }
 }
 
+/*
+ * Fast path for sunrpc XDRs.  rpcc's xdr_<type> functions instantiate
+ * the type's rpc_traverse with these instead of with XDR *, which
+ * makes an indirect call for every word.  xdr_sizer works out the
+ * exact encoded size, and xdr_fastenc then writes the whole thing into
+ * one region from XDR_INLINE.  xdr_fastdec reads straight out of an
+ * xdrmem's buffer.  Each is a flat run of loads, stores and byte
+ * swaps once the compiler has inlined the traversal.  Define
+ * RPC_NO_FASTXDR for types with an rpc_traverse (XDR *, ...) of their
+ * own and none for these.
+ *
+ * An xdrmem given an xdrarena with xdr_setarena decodes what rpc_ptrs
+ * point to and the elements of rpc_vecs into the arena rather than
+ * onto the heap, and with borrow set points opaque rpc_bytes straight
+ * into its buffer.  Strings still go on the heap, because copies of a
+ * str can outlive anything.  Such an object must be freed with
+ * xdr_arenadelete before the arena goes, and must be treated as read
+ * only: its pointers and vectors aren't the heap's to free or grow.
+ */
+
+enum { xdr_fastmax = 0x2000 };	// bigger goes the slow way, uncopied
+
+struct xdr_sizer {
+  size_t n;
+  xdr_sizer () : n (0) {}
+};
+
+struct xdr_fastenc {
+  char *cp;
+  explicit xdr_fastenc (char *p) : cp (p) {}
+  void putint (u_int32_t v) { v = htonl (v); memcpy (cp, &v, 4); cp += 4; }
+  void putpadbytes (const void *p, size_t n) {
+    memcpy (cp, p, n);
+    cp += n;
+    for (; n & 3; n++)
+      *cp++ = 0;
+  }
+};
+
+struct xdrarena {
+  arena *a;
+  bool borrow;			// rpc_bytes can point into the buffer
+};
+
+struct xdr_fastdec {
+  const char *cp;
+  const char *const lim;
+  const xdrarena *const xa;
+  xdr_fastdec (const char *p, size_t n, const xdrarena *x = NULL)
+    : cp (p), lim (p + n), xa (x) {}
+  bool getint (u_int32_t &v) {
+    if (lim - cp < 4)
+      return false;
+    memcpy (&v, cp, 4);
+    v = ntohl (v);
+    cp += 4;
+    return true;
+  }
+  // Returns n bytes, skipping the padding after them.
+  const char *getpadbytes (size_t n) {
+    size_t nn = (n + 3) & ~size_t (3);
+    if (nn < n || size_t (lim - cp) < nn)
+      return NULL;
+    const char *p = cp;
+    cp += nn;
+    return p;
+  }
+};
+
+inline bool
+rpc_traverse (xdr_sizer &s, u_int32_t &obj, RPC_FIELD)
+{
+  s.n += 4;
+  return true;
+}
+inline bool
+rpc_traverse (xdr_fastenc &e, u_int32_t &obj, RPC_FIELD)
+{
+  e.putint (obj);
+  return true;
+}
+inline bool
+rpc_traverse (xdr_fastdec &d, u_int32_t &obj, RPC_FIELD)
+{
+  return d.getint (obj);
+}
+
+template<size_t n> inline bool
+rpc_traverse (xdr_sizer &s, rpc_opaque<n> &obj, RPC_FIELD)
+{
+  s.n += (n + 3) & ~3;
+  return true;
+}
+template<size_t n> inline bool
+rpc_traverse (xdr_fastenc &e, rpc_opaque<n> &obj, RPC_FIELD)
+{
+  e.putpadbytes (obj.base (), n);
+  return true;
+}
+template<size_t n> inline bool
+rpc_traverse (xdr_fastdec &d, rpc_opaque<n> &obj, RPC_FIELD)
+{
+  const char *dp = d.getpadbytes (n);
+  if (!dp)
+    return false;
+  memcpy (obj.base (), dp, n);
+  return true;
+}
+
+template<size_t max> inline bool
+rpc_traverse (xdr_sizer &s, rpc_bytes<max> &obj, RPC_FIELD)
+{
+  s.n += 4 + ((obj.size () + 3) & ~3);
+  return true;
+}
+template<size_t max> inline bool
+rpc_traverse (xdr_fastenc &e, rpc_bytes<max> &obj, RPC_FIELD)
+{
+  e.putint (obj.size ());
+  e.putpadbytes (obj.base (), obj.size ());
+  return true;
+}
+template<size_t max> inline bool
+rpc_traverse (xdr_fastdec &d, rpc_bytes<max> &obj, RPC_FIELD)
+{
+  u_int32_t size;
+  const char *dp;
+  if (!d.getint (size) || size > obj.maxsize || !(dp = d.getpadbytes (size)))
+    return false;
+  if (!d.xa) {
+    obj.setsize (size);
+    sfs::memcpy_p (obj.base (), dp, size);
+  }
+  else if (d.xa->borrow)
+    obj.set (const_cast<char *> (dp), size);
+  else {
+    char *cp = static_cast<char *> (d.xa->a->alloc (size, 1));
+    sfs::memcpy_p (cp, dp, size);
+    obj.set (cp, size);
+  }
+  return true;
+}
+
+template<size_t max> inline bool
+rpc_traverse (xdr_sizer &s, rpc_str<max> &obj, RPC_FIELD)
+{
+  if (!obj)
+    return false;
+  s.n += 4 + ((obj.len () + 3) & ~3);
+  return true;
+}
+template<size_t max> inline bool
+rpc_traverse (xdr_fastenc &e, rpc_str<max> &obj, RPC_FIELD)
+{
+  e.putint (obj.len ());
+  e.putpadbytes (obj.cstr (), obj.len ());
+  return true;
+}
+template<size_t max> inline bool
+rpc_traverse (xdr_fastdec &d, rpc_str<max> &obj, RPC_FIELD)
+{
+  u_int32_t size;
+  const char *dp;
+  if (!d.getint (size) || size > max || !(dp = d.getpadbytes (size))
+      || memchr (dp, '\0', size))
+    return false;
+  obj.setbuf (dp, size);
+  return true;
+}
+
+inline bool
+rpc_traverse (xdr_sizer &s, str &obj, RPC_FIELD)
+{
+  if (!obj)
+    return false;
+  s.n += 4 + ((obj.len () + 3) & ~3);
+  return true;
+}
+inline bool
+rpc_traverse (xdr_fastenc &e, str &obj, RPC_FIELD)
+{
+  e.putint (obj.len ());
+  e.putpadbytes (obj.cstr (), obj.len ());
+  return true;
+}
+inline bool
+rpc_traverse (xdr_fastdec &d, str &obj, RPC_FIELD)
+{
+  u_int32_t size;
+  const char *dp;
+  if (!d.getint (size) || !(dp = d.getpadbytes (size))
+      || memchr (dp, '\0', size))
+    return false;
+  obj = str (dp, size);
+  return true;
+}
+
+template<class R> inline bool
+rpc_traverse (xdr_fastdec &d, rpc_ptr<R> &obj, RPC_FIELD)
+{
+  bool nonnil;
+  if (!rpc_traverse (d, nonnil))
+    return false;
+  if (!nonnil) {
+    obj.clear ();
+    return true;
+  }
+  if (!obj && d.xa)
+    obj.assign (new (*d.xa->a) R);
+  return rpc_traverse (d, *obj.alloc ());
+}
+
+template<class R, size_t n> inline bool
+rpc_traverse (xdr_fastdec &d, rpc_vec<R, n> &obj, RPC_FIELD)
+{
+  if (!d.xa)			// the generic one, in rpctypes.h
+    return rpc_traverse<xdr_fastdec, R, n> (d, obj, field);
+
+  // Every element takes at least 4 bytes, so a bogus size can't make
+  // us allocate much more than the message.
+  u_int32_t size;
+  if (!d.getint (size) || size > obj.maxsize
+      || size > size_t (d.lim - d.cp) / 4)
+    return false;
+  obj.clear ();
+  if (!size)
+    return true;
+  R *base = static_cast<R *> (d.xa->a->alloc (size * sizeof (R)));
+  for (R *p = base; p < base + size; p++)
+    new (static_cast<void *> (p)) R;
+  obj.set (base, size);
+  for (R *p = base; p < base + size; p++)
+    if (!rpc_traverse (d, *p))
+      return false;
+  return true;
+}
+
+/*
+ * Runs the destructors in an arena-decoded object, but leaves memory
+ * from the arena alone.
+ */
+struct xdr_arenafree {};
+
+inline bool
+rpc_traverse (xdr_arenafree &, u_int32_t &, RPC_FIELD)
+{
+  return true;
+}
+template<size_t n> inline bool
+rpc_traverse (xdr_arenafree &, rpc_opaque<n> &, RPC_FIELD)
+{
+  return true;
+}
+template<size_t max> inline bool
+rpc_traverse (xdr_arenafree &, rpc_bytes<max> &, RPC_FIELD)
+{
+  return true;
+}
+template<size_t max> inline bool
+rpc_traverse (xdr_arenafree &, rpc_str<max> &, RPC_FIELD)
+{
+  return true;
+}
+inline bool
+rpc_traverse (xdr_arenafree &, str &, RPC_FIELD)
+{
+  return true;
+}
+template<class R> inline bool
+rpc_traverse (xdr_arenafree &f, rpc_ptr<R> &obj, RPC_FIELD)
+{
+  if (obj) {
+    rpc_traverse (f, *obj);
+    obj.release ()->~R ();
+  }
+  return true;
+}
+template<class R, size_t n> inline bool
+rpc_traverse (xdr_arenafree &f, rpc_vec<R, n> &obj, RPC_FIELD)
+{
+  for (R *p = obj.base (); p < obj.lim (); p++)
+    rpc_traverse (f, *p);
+  if (obj.borrowed ())
+    for (R *p = obj.base (); p < obj.lim (); p++)
+      p->~R ();
+  return true;
+}
+
+// The unread part of an xdrmem being decoded, or NULL for other XDRs.
+const char *xdr_window (XDR *xdrs, size_t *availp);
+
+void xdr_setarena (XDR *xdrs, const xdrarena *xa);
+const xdrarena *xdr_getarena (XDR *xdrs);
+void xdr_arenadelete (sfs::xdrproc_t proc, void *objp);
+
+#ifndef RPC_NO_FASTXDR
+template<class T> bool
+xdr_fasttraverse (XDR *xdrs, T &obj)
+{
+  switch (xdrs->x_op) {
+  case XDR_ENCODE:
+    {
+      xdr_sizer s;
+      char *cp;
+      if (!rpc_traverse (s, obj) || s.n > xdr_fastmax
+	  || !(cp = (char *) XDR_INLINE (xdrs, s.n)))
+	break;
+      xdr_fastenc e (cp);
+      rpc_traverse (e, obj);
+      assert (e.cp == cp + s.n);
+      return true;
+    }
+  case XDR_DECODE:
+    {
+      size_t avail;
+      const char *cp = xdr_window (xdrs, &avail);
+      if (!cp)
+	break;
+      xdr_fastdec d (cp, avail, xdr_getarena (xdrs));
+      return rpc_traverse (d, obj) && XDR_INLINE (xdrs, d.cp - cp);
+    }
+  default:
+    break;
+  }
+  return rpc_traverse (xdrs, obj);
+}
+
+template<class T> void
+xdr_fastdestruct (XDR *xdrs, T *objp)
+{
+  if (xdr_getarena (xdrs)) {
+    xdr_arenafree f;
+    rpc_traverse (f, *objp);
+  }
+  objp->~T ();
+}
+#else /* RPC_NO_FASTXDR */
+template<class T> inline bool
+xdr_fasttraverse (XDR *xdrs, T &obj)
+{
+  return rpc_traverse (xdrs, obj);
+}
+template<class T> inline void
+xdr_fastdestruct (XDR *xdrs, T *objp)
+{
+  objp->~T ();
+}
+#endif /* RPC_NO_FASTXDR */
+
 template<class T> inline void
 rpc_destruct (T *objp)
 {
@@ -302,7 +652,9 @@ rpc_destruct (T *objp)
 inline void
 xdr_free (sfs::xdrproc_t proc, void *objp)
 {
+  // Zeroed, since xdr_getarena and xdr_virtualize look at x_ops.
   XDR x;
+  bzero (&x, sizeof (x));
   x.x_op = XDR_FREE;
   proc (&x, objp);
 }
@@ -34,7 +34,7 @@ public:
   const ref<axprt> xh;
   list<aclnt, &aclnt::xhlink> clist;
   ihash<const progvers, asrv, &asrv::pv, &asrv::xhlink> stab;
-  ihash<const u_int32_t, callbase, &callbase::xid, &callbase::hlink> xidtab;
+  xidtab_t xidtab;
   ihash_entry<xhinfo> hlink;
 
   void seteof (ref<xhinfo>, const sockaddr *);
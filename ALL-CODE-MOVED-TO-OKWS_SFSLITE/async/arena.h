@@ -33,6 +33,7 @@ protected:
 
   u_int size;
   u_int avail;
+  u_int hint;
   char *chunk;
   char *cur;
 
@@ -40,15 +41,15 @@ protected:
 
  public:
   arena () {
-    size = avail = 0;
+    size = avail = hint = 0;
     chunk = cur = 0;
   }
 
   void *alloc (size_t bytes, size_t align = sizeof (double)) {
-    int pad = (align - (chunk - (char *) 0)) % align;
+    int pad = (align - (cur - (char *) 0)) % align;
     if (avail < pad + bytes) {
       newchunk (bytes + align);
-      pad = (align - (chunk - (char *) 0)) % align;
+      pad = (align - (cur - (char *) 0)) % align;
     }
     void *ret = cur + pad;
     cur += bytes + pad;
@@ -67,7 +68,13 @@ protected:
     { return strcpy ((char *) alloc (1 + strlen (str), 1), str); }
 #endif /* DMALLOC */
 
-  ~arena ();
+  // Make the next chunk exactly n bytes (if that is enough), to get
+  // by with one chunk when the caller knows roughly how much it needs.
+  void sizehint (size_t n) { if (n > hint) hint = n; }
+  // Free everything at once.
+  void clear ();
+
+  ~arena () { clear (); }
 };
 
 inline void *
@@ -132,5 +132,26 @@ void printtxtlist (const char *msg, ptr<txtlist> s, int = 0);
 
 void dns_reload ();
 
+/* Answers are cached for as long as their TTLs (capped at maxttl)
+ * allow, and NXDOMAIN and empty answers for as long as the zone's SOA
+ * says (capped at maxnegttl).  Identical lookups in flight at the
+ * same time share one query.  With prefetch set, a cache hit within
+ * that many seconds of the entry's expiry refreshes it in the
+ * background.  maxentries of 0 turns the cache off.
+ */
+struct dnscache_stats {
+  u_int64_t hits;		/* Answered from the cache */
+  u_int64_t neghits;		/* ... with a cached error */
+  u_int64_t misses;		/* Sent to a name server */
+  u_int64_t coalesced;		/* Joined an identical query in flight */
+  u_int64_t prefetches;		/* Refreshed before expiring */
+  u_int64_t evictions;		/* Dropped to stay within maxentries */
+  size_t entries;
+};
+void dns_cache_config (size_t maxentries, u_int32_t maxttl = 86400,
+		       u_int32_t maxnegttl = 3600, u_int32_t prefetch = 0);
+void dns_cache_flush ();
+const dnscache_stats &dns_cache_getstats ();
+
 #endif /* !_DNS_H_ */
 
@@ -27,6 +27,7 @@
 
 #include "dnsparse.h"
 #include "ihash.h"
+#include "list.h"
 #include "backoff.h"
 
 class resolver;
@@ -40,9 +41,14 @@ public:
 private:
   bool constructed;
   bool intable;
+  timecb_t *cachetmo;		// Pending delivery of a cached reply
+  str cachedpkt;
+  void query ();
+  void cached ();
 protected:
   void remove ();
 public:
+  const bool refresh;		// Bypass the cache (for prefetches)
   int error;
   u_int16_t id;			// DNS query ID
   str basename;			// Name for which to search
@@ -51,11 +57,24 @@ public:
   ihash_entry<dnsreq> hlink;	// Per-id hash table link
   tmoq_entry<dnsreq> tlink;	// Retransmit queue link
 
-  dnsreq (resolver *, str, u_int16_t, bool search = false);
+  // Identical requests share one query.  The first is the leader, in
+  // the resolver's qtab; the rest wait on its waiters list.
+  str qkey;			// Cache key, or NULL if not cacheable
+  bool leader;
+  ihash_entry<dnsreq> qlink;
+  tailq_entry<dnsreq> wlink;
+  tailq<dnsreq, &dnsreq::wlink> waiters;
+  tailq<dnsreq, &dnsreq::wlink> *waitq;	// List we're waiting on
+  u_int32_t nxttl;		// Negative TTL of the last NXDOMAIN
+
+  dnsreq (resolver *, str, u_int16_t, bool search = false,
+	  bool refresh = false);
   virtual ~dnsreq ();
   void start (bool);
   void xmit (int = 0);
   virtual void readreply (dnsparse *) = 0;
+  void complete (dnsparse *);
+  void usecache (str pkt, int err);
   void timeout ();
   void fail (int);
 };
@@ -117,6 +136,27 @@ public:
   void readreply (dnsparse *);
 };
 
+class dnsreq_prefetch : public dnsreq {
+public:
+  dnsreq_prefetch (resolver *rp, str n, u_int16_t t, bool s)
+    : dnsreq (rp, n, t, s, true) {}
+  void readreply (dnsparse *) { delete this; }
+};
+
+struct dnscache_entry {
+  str key;
+  const str name;
+  const u_int16_t type;
+  const bool search;
+  str pkt;			// The reply, or NULL for NXDOMAIN
+  time_t expire;
+  ihash_entry<dnscache_entry> hlink;
+  tailq_entry<dnscache_entry> qlink;
+
+  dnscache_entry (const str &k, const str &n, u_int16_t t, bool s)
+    : key (k), name (n), type (t), search (s), expire (0) {}
+};
+
 class dnssock {
 public:
   typedef callback<void, u_char *, ssize_t>::ref cb_t;
@@ -170,15 +210,32 @@ protected:
   static void failreq (int err, dnsreq *r) { r->fail (err); }
   void pktready (bool tcp, u_char *qb, ssize_t size);
   void udpcheck_cb (ptr<hostent> h, int err);
+
+  ihash<str, dnscache_entry, &dnscache_entry::key,
+	&dnscache_entry::hlink> cachetab;
+  tailq<dnscache_entry, &dnscache_entry::qlink> cachelru; // Oldest first
+  size_t cachemax;
+  u_int32_t maxttl;
+  u_int32_t maxnegttl;
+  u_int32_t prefetch;
+  dnscache_stats cstats;
+  void cache_delete (dnscache_entry *e);
 public:
   time_t last_resp;		// Last time of valid reply from this server
   time_t last_bump;
   ref<bool> destroyed;
   ihash<u_int16_t, dnsreq, &dnsreq::id, &dnsreq::hlink> reqtab;
   tmoq<dnsreq, &dnsreq::tlink, 1, 5> reqtoq;
+  ihash<str, dnsreq, &dnsreq::qkey, &dnsreq::qlink> qtab;
 
   resolver ();
   virtual ~resolver ();
+  bool cache_attach (dnsreq *r);
+  void cache_insert (dnsreq *r, dnsparse *reply);
+  void cache_config (size_t maxentries, u_int32_t maxttl,
+		     u_int32_t maxnegttl, u_int32_t prefetch);
+  void cache_flush ();
+  const dnscache_stats &cache_getstats () const { return cstats; }
   bool setsock (bool failure);
   void sendreq (dnsreq *r);
   virtual const char *srchlist (int n) { return n <= 0 ? "" : NULL; }
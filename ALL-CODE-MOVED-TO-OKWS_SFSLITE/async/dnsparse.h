@@ -146,12 +146,15 @@ public:
 
   const u_char *getqp () { return hdr ? buf + sizeof (HEADER) : NULL; }
   const u_char *getanp () { return anp; }
+  const u_char *getbuf () { return buf; }
+  size_t getlen () { return eom - buf; }
 
   bool qparse (question *);
   bool qparse (const u_char **, question *);
   bool rrparse (const u_char **, resrec *);
 
   bool skipnrecs (const u_char **, u_int);
+  u_int32_t minttl (u_int32_t def);
 
   ptr<hostent> tohostent ();
   ptr<mxlist> tomxlist ();
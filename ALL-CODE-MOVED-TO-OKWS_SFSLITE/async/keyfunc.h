@@ -25,6 +25,8 @@
 #ifndef _KEYFUNC_H_
 #define _KEYFUNC_H_ 1
 
+#include "init.h"
+
 template<class T> struct unref_t {
   typedef T base_type;
   typedef T unref_type;
@@ -54,25 +56,30 @@ template<class T> struct unref_t<const T &> {
 #define UNCREF(T) unref_t<T>::base_type
 #define NCREF(T) unref_t<T>::ncref_type
 
+/*
+ * hash_bytes is wyhash: it eats 8 or 16 bytes per step with a 64x64
+ * to 128-bit multiply, and mixes in hash_key, a random number chosen
+ * once per process, so that nobody outside can pick keys that all
+ * land in one bucket.  Hash values therefore differ from run to run;
+ * never store them or send them anywhere.  Set SFS_HASHSEED to a
+ * number to get the same values every time, e.g. for debugging.
+ */
 #define HASHSEED 5381
+extern u_int64_t hash_key;
+u_int64_t hash_bytes64 (const void *key, size_t len, u_int64_t seed);
+INIT(hash_init);
+
 inline u_int
-hash_bytes (const void *_key, int len, u_int seed = HASHSEED)
+hash_bytes (const void *key, int len, u_int seed = HASHSEED)
 {
-  const u_char *key = (const u_char *) _key;
-  const u_char *end;
-
-  for (end = key + len; key < end; key++)
-    seed = ((seed << 5) + seed) ^ *key;
-  return seed;
+  u_int64_t h = hash_bytes64 (key, len, seed);
+  return h ^ (h >> 32);
 }
 
 inline u_int
-hash_string (const void *_p, u_int v = HASHSEED)
+hash_string (const void *p, u_int v = HASHSEED)
 {
-  const char *p = (const char *) _p;
-  while (*p)
-    v = (33 * v) ^ (unsigned char) *p++;
-  return v;
+  return hash_bytes (p, strlen ((const char *) p), v);
 }
 
 inline u_int
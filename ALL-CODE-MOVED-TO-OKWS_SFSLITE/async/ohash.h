@@ -0,0 +1,329 @@
+// -*-c++-*-
+/* $Id$ */
+
+/*
+ *
+ * Copyright (C) 1998 David Mazieres (dm@uun.org)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ * USA
+ *
+ */
+
+#ifndef _OHASH_H_
+#define _OHASH_H_ 1
+
+#include "qhash.h"
+
+//
+// ohash: a flat, open-addressing stand-in for qhash.  Keys and values
+// live in one array, each next to a 32-bit hash code, and collisions
+// are resolved by linear probing with Robin Hood ordering and
+// backward-shift deletion.  A lookup usually touches one cache line
+// and never follows a pointer, and there's no allocation per entry.
+//
+// The interface is qhash's, so a table can switch with a typedef, with
+// one catch: entries move.  A pointer returned by operator[] or a
+// slot from first ()/next () is good only until the next insert or
+// remove.  Don't modify the table while iterating over it.
+//
+
+template<class K, class V> struct ohash_slot {
+  const K key;
+  V value;
+  ohash_slot (const K &k, typename CREF (V) v) : key (k), value (v) {}
+  ohash_slot (const K &k, typename NCREF (V) v) : key (k), value (v) {}
+};
+
+template<class K, class V, class H = hashfn<K>, class E = equals<K>,
+	 class R = qhash_lookup_return<V> >
+class ohash {
+public:
+  typedef ohash_slot<K, V> slot;
+  enum { mincap = 8 };
+
+private:
+  const E eq;
+  const H hash;
+
+  // Cells are never constructed as a whole: code is always valid
+  // (0 for an empty cell) and s is constructed only when code isn't 0.
+  struct cell {
+    u_int32_t code;
+    slot s;
+  };
+
+  cell *cells;
+  size_t cap;			// a power of 2, or 0
+  size_t mask;
+  size_t nent;
+
+  // Spread the bits around, since hashfn is often the identity and
+  // only the low bits pick a cell.  The top bit is set so that no
+  // code is 0.
+  u_int32_t code (const K &k) const {
+    u_int32_t h = hash (k);
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h | 0x80000000;
+  }
+  size_t dist (size_t i) const { return (i - cells[i].code) & mask; }
+  static size_t index (const cell *c, const slot *s) {
+    return (reinterpret_cast<const char *> (s)
+	    - reinterpret_cast<const char *> (&c->s)) / sizeof (cell);
+  }
+
+  ssize_t find (const K &k) const {
+    if (!nent)
+      return -1;
+    u_int32_t c = code (k);
+    for (size_t i = c & mask, d = 0;; i = (i + 1) & mask, d++) {
+      u_int32_t ci = cells[i].code;
+      if (!ci || dist (i) < d)
+	return -1;
+      if (ci == c && eq (cells[i].s.key, k))
+	return i;
+    }
+  }
+
+  static void move (slot *dst, slot *src) {
+    new (static_cast<void *> (dst)) slot (src->key, src->value);
+    src->~slot ();
+  }
+
+  // Find k's place in the probe order, shift whatever is in the way
+  // over by one, and return the now uninitialized slot.
+  slot *place (u_int32_t c) {
+    size_t i = c & mask, d = 0;
+    while (cells[i].code && dist (i) >= d) {
+      i = (i + 1) & mask;
+      d++;
+    }
+    size_t j = i;
+    while (cells[j].code)
+      j = (j + 1) & mask;
+    for (; j != i; j = (j - 1) & mask) {
+      size_t p = (j - 1) & mask;
+      move (&cells[j].s, &cells[p].s);
+      cells[j].code = cells[p].code;
+    }
+    cells[i].code = c;
+    nent++;
+    return &cells[i].s;
+  }
+
+  void erase (size_t i) {
+    cells[i].s.~slot ();
+    for (size_t n = (i + 1) & mask; cells[n].code && dist (n);
+	 n = (n + 1) & mask) {
+      move (&cells[i].s, &cells[n].s);
+      cells[i].code = cells[n].code;
+      i = n;
+    }
+    cells[i].code = 0;
+    nent--;
+  }
+
+  void resize (size_t ncap) {
+    cell *ocells = cells;
+    size_t ocap = cap;
+
+    cap = ncap;
+    mask = ncap - 1;
+    nent = 0;
+    cells = static_cast<cell *> (xmalloc (ncap * sizeof (cell)));
+    for (size_t i = 0; i < ncap; i++)
+      cells[i].code = 0;
+
+    for (size_t i = 0; i < ocap; i++)
+      if (ocells[i].code)
+	move (place (ocells[i].code), &ocells[i].s);
+    xfree (ocells);
+  }
+
+  // Room for one more, at a load of at most 7/8.
+  void grow () {
+    if ((nent + 1) * 8 > cap * 7)
+      resize (cap ? cap * 2 : size_t (mincap));
+  }
+
+  void add (slot &s) {
+    grow ();
+    new (static_cast<void *> (place (code (s.key)))) slot (s.key, s.value);
+  }
+
+  void copy (const ohash &in) {
+    for (const slot *s = in.first (); s; s = in.next (s))
+      insert (s->key, s->value);
+  }
+
+  static void mkcbr (ref<callback<void, const K &, typename R::type> > cb,
+		     slot *s)
+    { (*cb) (s->key, R::ret (&s->value)); }
+
+public:
+  ohash () : eq (E ()), hash (H ()), cells (NULL), cap (0), mask (0),
+	     nent (0) {}
+  ohash (const ohash &in) : eq (E ()), hash (H ()), cells (NULL), cap (0),
+			    mask (0), nent (0)
+    { copy (in); }
+  ~ohash () {
+    clear ();
+    xfree (cells);
+  }
+
+  ohash &operator= (const ohash &in) {
+    if (this != &in) {
+      clear ();
+      copy (in);
+    }
+    return *this;
+  }
+
+  void clear () {
+    for (size_t i = 0; nent && i < cap; i++)
+      if (cells[i].code) {
+	cells[i].s.~slot ();
+	cells[i].code = 0;
+	nent--;
+      }
+  }
+  size_t size () const { return nent; }
+  bool empty () const { return !nent; }
+  void reserve (size_t n) {
+    size_t c = cap ? cap : size_t (mincap);
+    while (n * 8 > c * 7)
+      c *= 2;
+    if (c > cap)
+      resize (c);
+  }
+  // Bytes of table, not counting whatever keys and values point to.
+  size_t bytes () const { return cap * sizeof (cell); }
+
+  // k and v may refer into the table, which grow and place move
+  // around, so a new entry is copied out before either runs.
+  void insert (const K &k) {
+    ssize_t i = find (k);
+    if (i >= 0)
+      cells[i].s.value = V ();
+    else {
+      slot s (k, V ());
+      add (s);
+    }
+  }
+  void insert (const K &k, typename CREF (V) v) {
+    ssize_t i = find (k);
+    if (i >= 0)
+      cells[i].s.value = v;
+    else {
+      slot s (k, v);
+      add (s);
+    }
+  }
+  void insert (const K &k, typename NCREF (V) v) {
+    ssize_t i = find (k);
+    if (i >= 0)
+      cells[i].s.value = v;
+    else {
+      slot s (k, v);
+      add (s);
+    }
+  }
+
+  void remove (const K &k) {
+    ssize_t i = find (k);
+    if (i >= 0)
+      erase (i);
+  }
+  bool remove (const K &k, V *v) {
+    ssize_t i = find (k);
+    if (i < 0)
+      return false;
+    *v = cells[i].s.value;
+    erase (i);
+    return true;
+  }
+
+  typename R::type operator[] (const K &k) {
+    ssize_t i = find (k);
+    return R::ret (i >= 0 ? &cells[i].s.value : NULL);
+  }
+  typename R::const_type operator[] (const K &k) const {
+    ssize_t i = find (k);
+    return R::const_ret (i >= 0 ? &cells[i].s.value : NULL);
+  }
+
+  slot *first () const {
+    for (size_t i = 0; i < cap; i++)
+      if (cells[i].code)
+	return &cells[i].s;
+    return NULL;
+  }
+  slot *next (const slot *s) const {
+    for (size_t i = index (cells, s) + 1; i < cap; i++)
+      if (cells[i].code)
+	return &cells[i].s;
+    return NULL;
+  }
+
+  void traverse (ref<callback<void, const K &, typename R::type> > cb) {
+    for (slot *s = first (); s; s = next (s))
+      mkcbr (cb, s);
+  }
+};
+
+template<class K, class V, class H = hashfn<K>, class E = equals<K> >
+class ohash_const_iterator_t {
+public:
+  ohash_const_iterator_t (const ohash<K,V,H,E> &q)
+    : _i (q.first ()), _fh (q) {}
+  void reset () { _i = _fh.first (); }
+  const K *next (V *val = NULL) {
+    const K *r = NULL;
+    if (_i) {
+      if (val) *val = _i->value;
+      r = &_i->key;
+      _i = _fh.next (_i);
+    }
+    return r;
+  }
+private:
+  const ohash_slot<K,V> *_i;
+  const ohash<K,V,H,E> &_fh;
+};
+
+template<class K, class V, class H = hashfn<K>, class E = equals<K> >
+class ohash_iterator_t {
+public:
+  ohash_iterator_t (ohash<K,V,H,E> &q) : _i (q.first ()), _fh (q) {}
+  void reset () { _i = _fh.first (); }
+  const K *next (V *val = NULL) {
+    const K *r = NULL;
+    if (_i) {
+      if (val) *val = _i->value;
+      r = &_i->key;
+      _i = _fh.next (_i);
+    }
+    return r;
+  }
+private:
+  ohash_slot<K,V> *_i;
+  ohash<K,V,H,E> &_fh;
+};
+
+#endif /* !_OHASH_H_ */
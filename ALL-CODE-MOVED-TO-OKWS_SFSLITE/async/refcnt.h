@@ -265,6 +265,32 @@ TYPE2STRUCT(, long);
 TYPE2STRUCT(, unsigned long);
 TYPE2STRUCT(class U, U *);
 
+/* refcount_has_member<T>::has_finalize is true when T has a member
+ * called finalize, public or not, declared in T or in a base.  The
+ * lookup through probe is ambiguous exactly when T has one too.
+ * has_refcount likewise probes refcount_call_finalize to detect
+ * refcount as a base of T. */
+struct refcount_probe {
+  void finalize ();
+  void refcount_call_finalize ();
+};
+template<class T> class refcount_has_member {
+  struct both : T, refcount_probe {};
+  template<void (refcount_probe::*)()> struct check {};
+  template<class U> static long f (check<&U::finalize> *);
+  template<class U> static char f (...);
+  template<class U> static long r (check<&U::refcount_call_finalize> *);
+  template<class U> static char r (...);
+public:
+  enum { has_finalize = sizeof (f<both> (NULL)) == sizeof (char),
+	 has_refcount = sizeof (r<both> (NULL)) == sizeof (char) };
+};
+template<bool> struct refcount_finalize_tag {};
+template<bool> struct finalize_requires_virtual_base_of_refcount;
+template<> struct finalize_requires_virtual_base_of_refcount<true> {
+  static void check () {}
+};
+
 template<class T>
 class refcounted<T, scalar>
   : virtual private refcount, private type2struct<T>::type
@@ -306,8 +332,8 @@ class refcounted<T, scalar>
    *
    * This code solves the problem by calling finalize from
    * refcounted<T> rather than refcount.  If the user forgets to give
-   * myclass a virtual refcount subtype, the call to finalize from
-   * refount_call_finalize is ambiguous and flags an error.
+   * myclass a virtual refcount subtype, call_finalize below fails to
+   * compile.
    *
    * An added benefit of this scheme is that refcount is now a pure
    * virtual class (call_finalize is an abstract method).  This means
@@ -319,13 +345,27 @@ class refcounted<T, scalar>
    * method always expects to be refcounted.  This scheme makes it
    * hard to violate the requirement accidentally. */
   void refcount_call_finalize () {
-    /* An error on the following line probably means you forgot to
-     * give T a virtual base class of refcount.  Alternatively, T
-     * already has a method called finalize unrelated to the reference
-     * counting.  In that case you will have to rename finalize to use
-     * a refcounted<T>. */
-    finalize ();
+    call_finalize (static_cast<refcount_finalize_tag<
+		   refcount_has_member<obj_t>::has_finalize> *> (NULL));
+  }
+  /* Newer compilers bind an unqualified finalize to refcount, which
+   * is not a dependent base, and never find T's.  So T's finalize is
+   * named explicitly, which also enforces its access.
+   *
+   * An error on the following lines probably means you forgot to
+   * give T a virtual base class of refcount.  Alternatively, T
+   * already has a method called finalize unrelated to the reference
+   * counting.  In that case you will have to rename finalize to use
+   * a refcounted<T>. */
+  typedef typename type2struct<T>::type obj_t;
+  void call_finalize (refcount_finalize_tag<true> *) {
+    finalize_requires_virtual_base_of_refcount<
+      refcount_has_member<obj_t>::has_refcount>::check ();
+    (void) static_cast<refcount *> (this);
+    this->obj_t::finalize ();
   }
+  void call_finalize (refcount_finalize_tag<false> *)
+    { refcount::finalize (); }
 
   ~refcounted () {}
 
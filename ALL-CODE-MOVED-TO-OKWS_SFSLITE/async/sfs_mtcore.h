@@ -0,0 +1,104 @@
+// -*-c++-*-
+/* $Id$ */
+
+/*
+ *
+ * Copyright (C) 1998 David Mazieres (dm@uun.org)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ * USA
+ *
+ */
+
+#ifndef _ASYNC_SFS_MTCORE_H_
+#define _ASYNC_SFS_MTCORE_H_ 1
+
+#include "async.h"
+#include "sfs_select.h"
+
+//-----------------------------------------------------------------------
+//
+//  Multi-core mode: run one event loop per thread.
+//
+//  Loop 0 is the main loop (the one amain() runs).  mtcore_start()
+//  spawns n-1 worker threads, each with a private selector, timer
+//  tree, yield queue and lazy list, so fdcb/timecb/delaycb/yieldcb
+//  called from a worker apply only to that worker's loop.  Signals
+//  and child reaping stay on the main loop; workers block all signals.
+//
+//  The rest of the library is still single-threaded: refcounted
+//  objects, str's and callbacks must never be shared between loops.
+//  Loops talk to each other only through mtcore_post (a function
+//  pointer and an opaque argument) and mtcore_post_fd (a file
+//  descriptor), both of which are safe to call from any thread.
+//
+//  Needs --enable-mtcore at configure time; otherwise mtcore_start()
+//  fails for n > 1 and everything runs on loop 0.
+//
+
+namespace sfs_core {
+
+  typedef void (*mtcore_fn_t) (void *arg);
+  typedef void (*mtcore_init_fn_t) (u_int loop, void *arg);
+
+  // Spawn workers so that there are n loops in total.  init is called
+  // on each loop's own thread (for loop 0, before returning) so that
+  // per-loop state -- listeners, handlers, timers -- can be set up.
+  // Workers use the select policy the main loop has at the time.
+  // Returns 0 on success, -1 on failure; can be called only once.
+  int mtcore_start (u_int n, mtcore_init_fn_t init, void *arg);
+
+  // Stop and join all worker threads.  Main loop only.
+  void mtcore_stop ();
+
+  u_int mtcore_nloops ();
+  u_int mtcore_loop ();              // index of the calling thread's loop
+
+  // Run fn(arg) on the given loop, soon.  Thread-safe.
+  void mtcore_post (u_int loop, mtcore_fn_t fn, void *arg);
+
+  // Set up loop 0 to take posts.  mtcore_start and the first post do
+  // it, but call this on the main loop first if a thread that is not
+  // a loop might make the first post.
+  void mtcore_init ();
+
+  // Hand fd to the given loop, which passes it to the callback that
+  // loop set with mtcore_set_fdcb.  Thread-safe.
+  void mtcore_post_fd (u_int loop, int fd);
+
+  // Set the calling loop's handler for fds handed to it.
+  void mtcore_set_fdcb (cbi::ptr cb);
+
+  // Accept connections on listening socket lfd from the calling loop,
+  // and deal them round-robin to all loops (this one included) via
+  // mtcore_post_fd.  Pass -1 to stop accepting.
+  void mtcore_listen (int lfd);
+
+  struct mtcore_stats_t {
+    mtcore_stats_t () : n_posted (0), n_fds (0), n_wakeups (0) {}
+    u_int64_t n_posted;
+    u_int64_t n_fds;
+    u_int64_t n_wakeups;
+  };
+
+  // Counters for one loop, read without locking; approximate.
+  mtcore_stats_t mtcore_stats (u_int loop);
+
+};
+
+//
+//-----------------------------------------------------------------------
+
+#endif /* _ASYNC_SFS_MTCORE_H_ */
@@ -2,6 +2,7 @@
 /* $Id: async.h 4052 2009-02-12 13:22:01Z max $ */
 
 #include "async.h"
+#include "sfs_select.h"
 
 #ifndef __ASYNC__SFS_PROFILER_H__
 #define __ASYNC__SFS_PROFILER_H__
@@ -41,6 +42,74 @@ public:
   static void init ();
   static void set_core (sfs_profiler::core_t *c);
 
+  //
+  // Write out the samples taken since the last reset.  PPROF is the
+  // CPU profile format of gperftools, for pprof.  COLLAPSED is one
+  // line per distinct stack, "frame;frame;...;frame count", for
+  // flamegraph.pl and friends, with the callback sites (below) as the
+  // outermost frames; symbols are left mangled.  Both only cover the
+  // built-in core, not one given with set_core.  A repeated stack is
+  // stored once with a count; new stacks past 16MB are dropped, and
+  // write reports how many.
+  //
+  enum format_t { PPROF = 0, COLLAPSED = 1 };
+  static bool write (const str &path, format_t f);
+
+  //
+  // Turn the profiler on when sig arrives; on the next one, turn it
+  // off, write path (PPROF) and path.collapsed, and reset.  So a
+  // running server can be profiled with kill -SIG and no restart.
+  //
+  static void toggle_on_signal (int sig, const str &path);
+
+  //
+  // What the event loop is running.  Every dispatch of a timer, fd,
+  // signal, lazy or yield callback, and every reentry of a tame
+  // function, keeps a site_t on the stack while it runs, and each
+  // sample is tagged with the chain of them.  That attributes time
+  // to handlers even where the C++ stack shows only wrap's glue.  A
+  // site costs two stores going in and one coming out; without
+  // --enable-simple-profiler it costs nothing.
+  //
+  class site_t {
+  public:
+#ifdef SIMPLE_PROFILER
+    site_t (const char *k, const char *f, int l, const char *fn = NULL)
+      : kind (k), file (f), func (fn), line (l), up (_top) { push (); }
+    site_t (const char *k, const sfs_core::src_loc_t &loc)
+      : kind (k), file (loc.file ()), func (NULL), line (loc.line ()),
+	up (_top) { push (); }
+    // With WRAP_DEBUG, names where cb was wrapped; file is then
+    // "file:line" and line 0.
+    site_t (const char *k, const callback<void> &cb)
+#if WRAP_DEBUG
+      : kind (k), file (cb.line), func (cb.dest), line (0), up (_top)
+#else /* !WRAP_DEBUG */
+      : kind (k), file (NULL), func (NULL), line (0), up (_top)
+#endif /* !WRAP_DEBUG */
+      { push (); }
+    ~site_t () { _top = up; }
+
+    const char *const kind;
+    const char *const file;		// NULL if unknown
+    const char *const func;		// NULL if unknown
+    const int line;			// 0 if unknown
+    const site_t *const up;
+
+    static const site_t *top () { return _top; }
+  private:
+    void push () {
+      // The sampler reads _top from a signal handler on this thread.
+      __asm__ __volatile__ ("" ::: "memory");
+      _top = this;
+    }
+    static SFS_TLS const site_t *volatile _top;
+#else /* !SIMPLE_PROFILER */
+    site_t (const char *k, const char *f, int l, const char *fn = NULL) {}
+    site_t (const char *k, const sfs_core::src_loc_t &loc) {}
+    site_t (const char *k, const callback<void> &cb) {}
+#endif /* !SIMPLE_PROFILER */
+  };
 };
 
 //
@@ -27,6 +27,12 @@
 
 #include "amisc.h"
 
+#ifdef HAVE_IO_URING
+# include <linux/io_uring.h>
+# include "list.h"
+# include "vec.h"
+#endif /* HAVE_IO_URING */
+
 //-----------------------------------------------------------------------
 //
 //  Deal with select(2) call, especially if in the case of PTH threads
@@ -71,7 +77,12 @@ namespace sfs_core {
   typedef enum { SELECT_NONE, 
 		 SELECT_STD, 
 		 SELECT_EPOLL, 
-		 SELECT_KQUEUE } select_policy_t;
+		 SELECT_KQUEUE,
+		 SELECT_EPOLL_ET,
+		 SELECT_URING } select_policy_t;
+
+  typedef enum { TIMER_ITREE,
+		 TIMER_WHEEL } timer_policy_t;
 
   select_policy_t select_policy_from_str  (const str &s);
   select_policy_t select_policy_from_char (char c);
@@ -79,12 +90,77 @@ namespace sfs_core {
   void set_busywait (bool b);   
   void set_compact_interval (u_int i);
   int  set_select_policy (select_policy_t i);
+  int  set_timer_policy (timer_policy_t p);
   void set_zombie_collect (bool b);
 
+  //
+  // Call first thing in a child that was fork()ed from inside the
+  // event loop and keeps running it (rather than exec'ing).  Gives the
+  // child a private signal pipe and kernel event queue; timers and fd
+  // callbacks it inherited stay in place.
+  //
+  void fork_reset ();
+
+  //
+  // Asynchronous readv/writev through the calling loop's io_uring;
+  // only available under SELECT_URING.  Requests are queued and go to
+  // the kernel along with everything else at the next trip through
+  // the select loop.  The iovec array is copied, but the buffers it
+  // points to must stay put until cb is called with what readv or
+  // writev would have returned, or -errno.  cb is always called,
+  // even after uring_cancel ().  Returns a request handle, or 0 if
+  // the caller should do the I/O itself.
+  //
+  // uring_wait blocks until one of the given requests (0 for none)
+  // completes and runs its callback; anything else that completes in
+  // the meantime is left for the select loop.
+  //
+  typedef callback<void, ssize_t>::ref uring_cb_t;
+  u_int64_t uring_readv (int fd, const iovec *iov, int iovcnt, uring_cb_t cb);
+  u_int64_t uring_writev (int fd, const iovec *iov, int iovcnt, uring_cb_t cb);
+  void uring_cancel (u_int64_t id);
+  void uring_wait (u_int64_t id1, u_int64_t id2 = 0);
+
   //
   // end public API
   //-----------------------------------------------------------------------
-  
+
+  //-----------------------------------------------------------------------
+  //
+  // Per-thread event loop state.  Normally there is just the main
+  // loop, but multi-core mode (sfs_mtcore.h) runs one loop per worker
+  // thread, each with its own selector, timers and yield queues.
+  //
+  struct loop_state_t;
+  loop_state_t *loop_state_alloc (u_int id, select_policy_t p);
+  void loop_state_install (loop_state_t *l);
+  void loop_run (const volatile bool *stop);
+  u_int loop_id ();
+  select_policy_t loop_policy ();
+
+#ifdef HAVE_SFS_MTCORE
+# define SFS_TLS __thread
+#else /* !HAVE_SFS_MTCORE */
+# define SFS_TLS
+#endif /* HAVE_SFS_MTCORE */
+
+  //
+  //-----------------------------------------------------------------------
+
+  // source code locations
+  class src_loc_t {
+  public:
+    src_loc_t () : _file (NULL), _line (0) {}
+    void set (const char *f, int l);
+    void clear ();
+    str to_str () const;
+    const char *file () const { return _file; }
+    int line () const { return _line; }
+  private:
+    const char *_file;
+    int _line;
+  };
+
   class selector_t {
   public:
     selector_t ();
@@ -103,23 +179,18 @@ namespace sfs_core {
 
     cbv::ptr **fdcbs () { return _fdcbs; }
 
+    // Where each fd callback was registered, for the profiler and
+    // debugging.  Set by ::_fdcb, so all selectors share it.
+    src_loc_t **src_locs () { return _src_locs; }
+    void set_src_loc (int fd, selop op, const char *f, int l)
+    { if (f) _src_locs[op][fd].set (f, l); else _src_locs[op][fd].clear (); }
+    const src_loc_t &src_loc (int fd, int op) const
+    { return _src_locs[op][fd]; }
+
     enum { fdsn = 2  };
   protected:
     cbv::ptr *_fdcbs[fdsn];
-  };
-
-  // source code locations
-  class src_loc_t {
-  public:
-    src_loc_t () : _file (NULL), _line (0) {}
-    void set (const char *f, int l);
-    void clear ();
-    str to_str () const;
-    const char *file () const { return _file; }
-    int line () const { return _line; }
-  private:
-    const char *_file;
-    int _line;
+    src_loc_t *_src_locs[fdsn];
   };
 
   class std_selector_t : public selector_t {
@@ -147,8 +218,6 @@ namespace sfs_core {
     fd_set *_fdsp[fdsn];
     fd_set *_fdspt[fdsn];
 
-    src_loc_t *_src_locs[fdsn];
-
     int _last_fd, _last_i, _n_repeats;
   };
 
@@ -177,8 +246,123 @@ namespace sfs_core {
     int user_events_to_epoll_events(epoll_state* es);
     int update_epoll_state(epoll_state* es) ;
   };
+
+  //
+  // Edge-triggered epoll.  Reads stay level-triggered, but write
+  // interest lives in a second, edge-triggered epoll set nested inside
+  // the first.  An fd goes into that set once, after which toggling
+  // selwrite on it costs no system calls.  All epoll_ctl calls wait
+  // for the next fdcb_check, and changes that cancel out are dropped.
+  //
+  // Only a write callback that is still registered after it runs
+  // (i.e., the socket is backed up) costs an epoll_ctl, to re-arm the
+  // edge.
+  //
+  class epoll_et_selector_t : public selector_t {
+  public:
+    epoll_et_selector_t (selector_t *cur);
+    ~epoll_et_selector_t ();
+    void _fdcb (int, selop, cbv::ptr, const char *, int);
+    void fdcb_check (struct timeval *timeout);
+    select_policy_t typ () const { return SELECT_EPOLL_ET; }
+
+  private:
+    struct fd_state_t {
+      int  want;     // READ and WRITE bits, as set through _fdcb
+      bool in_rset;  // registered in _epfd
+      bool in_wset;  // registered in _wepfd
+      bool dirty;    // on _dirty
+      bool reset;    // all interest dropped; fd may have been reused
+      bool rearm;    // write callback didn't finish; poll again
+      bool wready;   // writable as of the last edge
+      bool wqueued;  // on _wq
+    };
+
+    void mark_dirty (int fd);
+    void queue_write (int fd);
+    void flush ();
+    void sync (int epfd, int fd, bool *in, bool want, int events, bool stale);
+    int ctl (int epfd, int op, int fd, int events);
+
+    int _epfd, _wepfd;
+    struct epoll_event *_ret_events;
+    int _maxevents;
+    fd_state_t *_fds;
+    vec<int> _dirty;
+    vec<int> _wq, _wq_running;
+  };
 #endif /* HAVE_EPOLL */
 
+#ifdef HAVE_IO_URING
+
+  //
+  // Linux io_uring.  Readiness is polled with POLL_ADD requests, and
+  // uring_readv/uring_writev requests share the same queue, so that
+  // one io_uring_enter per loop iteration submits all changes and
+  // waits for completions.  Polls are one-shot, re-armed for as long
+  // as the callback stays registered; that keeps the level-triggered
+  // behavior callers expect, and re-arming costs no system call.
+  //
+  class uring_selector_t : public selector_t {
+  public:
+    uring_selector_t (selector_t *cur);
+    ~uring_selector_t ();
+    void _fdcb (int, selop, cbv::ptr, const char *, int);
+    void fdcb_check (struct timeval *timeout);
+    select_policy_t typ () const { return SELECT_URING; }
+
+    u_int64_t submit_rw (int opcode, int fd, const iovec *iov, int iovcnt,
+			 uring_cb_t cb);
+    void cancel (u_int64_t id);
+    void wait (u_int64_t id1, u_int64_t id2);
+
+    static bool supported ();
+
+  private:
+    struct req_t {
+      enum { POLL, IO } kind;
+      bool live;                  // POLL: still wanted; IO: not yet reaped
+      int fd;
+      selop op;
+      uring_cb_t::ptr cb;
+      vec<iovec, 4> iov;
+      list_entry<req_t> link;
+      req_t (int f, selop o) : kind (POLL), live (true), fd (f), op (o) {}
+      req_t (int f, uring_cb_t c) : kind (IO), live (true), fd (f), cb (c) {}
+    };
+
+    io_uring_sqe *get_sqe ();
+    io_uring_sqe *prep (int opcode, int fd, req_t *r);
+    struct held_t {
+      req_t *req;
+      int res;
+      held_t (req_t *r, int s) : req (r), res (s) {}
+    };
+
+    int enter (u_int to_submit, u_int min_complete, const timespec *ts);
+    void reap (vec<held_t> *out);
+    void arm (int fd, selop op);
+    void disarm (int fd, selop op);
+    void complete (req_t *r, int res);
+    void drain ();
+
+    int _ringfd;
+    void *_sq_ring, *_cq_ring;
+    size_t _sq_ring_sz, _cq_ring_sz;
+    io_uring_sqe *_sqes;
+    size_t _sqes_sz;
+    u_int *_sq_head, *_sq_tail, *_sq_mask, *_sq_array;
+    u_int *_cq_head, *_cq_tail, *_cq_mask;
+    io_uring_cqe *_cqes;
+    u_int _sq_local_tail;      // SQEs filled in but not yet submitted
+
+    req_t **_polls[fdsn];      // armed poll, per fd and op
+    list<req_t, &req_t::link> _reqs;
+    u_int _n_io;               // IO requests not yet reaped
+    vec<held_t> _held;         // reaped by wait (), not yet run
+  };
+#endif /* HAVE_IO_URING */
+
 };
 
 #ifdef HAVE_KQUEUE
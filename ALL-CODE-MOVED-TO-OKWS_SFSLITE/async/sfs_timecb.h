@@ -0,0 +1,198 @@
+// -*-c++-*-
+/* $Id$ */
+
+/*
+ *
+ * Copyright (C) 1998 David Mazieres (dm@uun.org)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ * USA
+ *
+ */
+
+#ifndef _ASYNC_SFS_TIMECB_H_
+#define _ASYNC_SFS_TIMECB_H_ 1
+
+#include "async.h"
+#include "itree.h"
+#include "list.h"
+#include "vec.h"
+#include "sfs_select.h"
+
+//-----------------------------------------------------------------------
+//
+//  Timer storage behind timecb/delaycb/timecb_remove.  Each event loop
+//  keeps its pending timecb_t's in a timecb_set_t, one of:
+//
+//   TIMER_ITREE -- a red-black tree ordered by timespec; O(log n) arm
+//     and cancel, exact ordering.  The default.
+//
+//   TIMER_WHEEL -- a hierarchical timing wheel with 1ms ticks: four
+//     levels of 256 slots (about 49 days), plus an overflow list
+//     beyond that.  O(1) arm and cancel.  Timers never fire early,
+//     but timers within the same millisecond fire in arming order.
+//
+//  Pick one with sfs_core::set_timer_policy, or SFS_OPTIONS=w.
+//
+
+struct timecb_t {
+  timespec ts;
+  const cbv cb;
+  itree_entry<timecb_t> link;        // TIMER_ITREE
+
+  u_int64_t tick;                    // TIMER_WHEEL
+  tailq_entry<timecb_t> wlink;
+  int16_t wlevel;
+  u_int16_t widx;
+
+  u_int32_t magic;
+  enum { ARMED = 0x71e3cb01, DEAD = 0xdeadcb00, FREED = 0xfeedcb02 };
+
+  timecb_t (const timespec &t, const cbv &c)
+    : ts (t), cb (c), tick (0), wlevel (-1), widx (0), magic (DEAD) {}
+};
+
+namespace sfs_core {
+
+  //-----------------------------------------------------------------------
+
+  // Recycles timecb_t storage, so that arming a timer doesn't go to
+  // malloc in the steady state.  One per loop, so no locking.
+  //
+  // Freed timers are marked FREED and reused oldest first, and only
+  // once quarantine newer ones have been freed behind them.  So a
+  // stale handle passed to timecb_remove trips the magic check,
+  // rather than cancelling whatever timer got its storage, unless the
+  // caller has held on to it through that many frees.
+  class timecb_pool_t {
+  public:
+    enum { quarantine = 0x400 };
+    timecb_pool_t (size_t mx = 0x4000)
+      : _head (NULL), _tail (NULL), _n (0), _max (max<size_t> (mx, quarantine))
+    {}
+    ~timecb_pool_t ();
+    timecb_t *alloc (const timespec &ts, const cbv &cb);
+    void dealloc (timecb_t *t);
+    size_t size () const { return _n; }
+  private:
+    // Overlays the front of a freed timecb_t, leaving magic alone.
+    struct free_t { free_t *next; };
+    free_t *_head, *_tail;
+    size_t _n, _max;
+  };
+
+  //-----------------------------------------------------------------------
+
+  class timecb_set_t {
+  public:
+    virtual ~timecb_set_t () {}
+    virtual void insert (timecb_t *t) = 0;
+    virtual void remove (timecb_t *t) = 0;
+
+    // To fire timers: call begin_pass with the current time, then pop
+    // until it returns NULL.  Timers armed during the pass wait for
+    // the next one.
+    virtual void begin_pass (const timespec &now) = 0;
+    virtual timecb_t *pop () = 0;
+
+    // A lower bound on the next expiration; false if there are no
+    // timers at all.
+    virtual bool next_expiry (timespec *ts) = 0;
+
+    // Unlink every timer into out; for switching policies.
+    virtual void remove_all (vec<timecb_t *> *out) = 0;
+
+    virtual timer_policy_t typ () const = 0;
+  };
+
+  //-----------------------------------------------------------------------
+
+  class itree_timecb_set_t : public timecb_set_t {
+  public:
+    itree_timecb_set_t () : _cursor (NULL), _altered (false)
+    { _now.tv_sec = _now.tv_nsec = 0; }
+    void insert (timecb_t *t);
+    void remove (timecb_t *t);
+    void begin_pass (const timespec &now);
+    timecb_t *pop ();
+    bool next_expiry (timespec *ts);
+    void remove_all (vec<timecb_t *> *out);
+    timer_policy_t typ () const { return TIMER_ITREE; }
+  private:
+    itree<timespec, timecb_t, &timecb_t::ts, &timecb_t::link> _tree;
+    timespec _now;
+    timecb_t *_cursor;
+    bool _altered;
+  };
+
+  //-----------------------------------------------------------------------
+
+  class wheel_timecb_set_t : public timecb_set_t {
+  public:
+    enum { LEVEL_BITS = 8,
+	   NSLOTS = 1 << LEVEL_BITS,
+	   SLOT_MASK = NSLOTS - 1,
+	   NLEVELS = 4 };
+
+    wheel_timecb_set_t ();
+    void insert (timecb_t *t);
+    void remove (timecb_t *t);
+    void begin_pass (const timespec &now);
+    timecb_t *pop ();
+    bool next_expiry (timespec *ts);
+    void remove_all (vec<timecb_t *> *out);
+    timer_policy_t typ () const { return TIMER_WHEEL; }
+
+  private:
+    typedef tailq<timecb_t, &timecb_t::wlink> slot_t;
+
+    // wlevel values for timers not in one of the wheel's levels
+    enum { IN_NONE = -1,
+	   IN_OVERFLOW = NLEVELS,
+	   IN_EXPIRED = NLEVELS + 1,
+	   IN_RUN = NLEVELS + 2 };
+
+    static u_int64_t ts2tick (const timespec &ts, bool roundup);
+    static timespec tick2ts (u_int64_t t);
+
+    void place (timecb_t *t);
+    void link (timecb_t *t, int level, u_int idx);
+    void unlink (timecb_t *t);
+    slot_t *slot (int level, u_int idx);
+    void advance (u_int64_t to);
+    void cascade ();
+    void requeue (slot_t *s);
+
+    u_int64_t _now;                    // all ticks <= _now processed
+    slot_t _wheel[NLEVELS][NSLOTS];
+    size_t _nlevel[NLEVELS];
+    slot_t _overflow;                  // more than 2^32 ticks out
+    slot_t _expired;                   // due, waiting for a pass
+    slot_t _run;                       // due, in the current pass
+    size_t _n;
+  };
+
+  //-----------------------------------------------------------------------
+
+  timecb_set_t *timecb_set_alloc (timer_policy_t p);
+
+  //-----------------------------------------------------------------------
+
+};
+
+//
+//-----------------------------------------------------------------------
+
+#endif /* _ASYNC_SFS_TIMECB_H_ */
@@ -45,10 +45,23 @@ size_t iovsize (const iovec *, int);
 
 class str;
 
+/* Scratch blocks that suios allocate with the default allocator come
+ * from a per-thread pool, in size classes of whole blocks (up to
+ * maxclass of them).  These are the calling thread's counters. */
+struct suio_pool_stats {
+  u_int64_t hits;		// allocations served from the pool
+  u_int64_t misses;		// allocations that had to go to malloc
+  u_int64_t drops;		// frees that went to free, pool being full
+  size_t bytes_cached;		// bytes now sitting in the pool
+};
+void suio_getpoolstats (suio_pool_stats *);
+void suio_trimpool ();		// give the calling thread's pool back
+
 class suio {
 public:
   enum { smallbufsize = 0x80 };
   enum { blocksize = 0x2000 };
+  enum { maxclass = 8 };	// largest pooled scratch, in blocks
 
 private:
   typedef callback<void>::ref cb_t;
@@ -61,8 +74,19 @@ private:
     uiocb (u_int64_t nb, cb_t cb) : cb (cb), nbytes (nb) {}
   };
 
+  // Scratch buffers to free once the bytes up to nbytes are gone.
+  struct scratchfree {
+    u_int64_t nbytes;
+    void (*dealloc) (void *, size_t);
+    char *buf;
+    size_t len;
+    scratchfree (u_int64_t nb, void (*d) (void *, size_t), char *b, size_t l)
+      : nbytes (nb), dealloc (d), buf (b), len (l) {}
+  };
+
   vec<iovec, 4> iovs;
   vec<uiocb, 2> uiocbs;
+  vec<scratchfree, 2> condemned;
 
   // Hold onto some data objects until after the suio disappears...
   vec<ptr<void > > m_hold_voids;
@@ -87,8 +111,8 @@ protected:
 
   char defbuf[smallbufsize];
 
-  static void *default_allocator (size_t n) { return txmalloc (n); }
-  static void default_deallocator (void *p, size_t) { xfree (p); }
+  static void *default_allocator (size_t n);
+  static void default_deallocator (void *p, size_t n);
 
   void makeuiocbs ();
   char *morescratch (size_t);
@@ -28,16 +28,49 @@
 
 #include "sysconf.h"
 
+/*
+ * Blocks go through a kernel picked the first time one is needed:
+ * AES-NI where the CPU has it, otherwise a bitsliced constant-time
+ * kernel that does 4 blocks at once in 64-bit words.  The original
+ * table-driven code is still there, but its lookups leak key bits
+ * through the cache, so it is only used when asked for by name.
+ *
+ * The multi-block calls let a kernel keep several blocks in flight;
+ * callers with more than one independent block (ECB, CTR, OCB) should
+ * hand them over together, ideally pipeline at a time.
+ */
+
 class aes_e {
 protected:
   int nrounds;
   u_int32_t  e_key[60];
+  u_int64_t  ct_key[120];	// e_key, bitsliced
   void setkey_e (const char *key, u_int keylen);
 public:
-  ~aes_e () { nrounds = 0; bzero (e_key, sizeof (e_key)); }
+  enum { blocksize = 16, pipeline = 8 };
+
+  ~aes_e () {
+    nrounds = 0;
+    bzero (e_key, sizeof (e_key));
+    bzero (ct_key, sizeof (ct_key));
+  }
   void setkey (const void *key, u_int keylen);
-  void encipher_bytes (void *buf, const void *ibuf) const;
+  void encipher_bytes (void *buf, const void *ibuf) const
+    { encipher_blocks (buf, ibuf, 1); }
   void encipher_bytes (void *buf) const { encipher_bytes (buf, buf); }
+
+  /* Enciphers nblk consecutive blocks (ECB); dst may be src. */
+  void encipher_blocks (void *dst, const void *src, size_t nblk) const;
+
+  /* CTR mode.  Xors len bytes of key stream into src and writes them
+   * to dst (which may be src).  ctr is the 16-byte big-endian counter
+   * block for the first block; it is left pointing past the last
+   * block used, including a final partial one. */
+  void ctr_crypt (void *dst, const void *src, size_t len, void *ctr) const;
+
+  // Name of the kernel in use, and a way to pick another for testing.
+  static const char *impl ();
+  static bool setimpl (const char *name);
 };
 
 class aes : public aes_e {
@@ -47,8 +80,12 @@ protected:
 public:
   ~aes () { bzero (d_key, sizeof (d_key)); }
   void setkey (const void *key, u_int keylen);
-  void decipher_bytes (void *buf, const void *ibuf) const;
+  void decipher_bytes (void *buf, const void *ibuf) const
+    { decipher_blocks (buf, ibuf, 1); }
   void decipher_bytes (void *buf) const { decipher_bytes (buf, buf); }
+
+  /* Deciphers nblk consecutive blocks (ECB); dst may be src. */
+  void decipher_blocks (void *dst, const void *src, size_t nblk) const;
 };
 
 #endif /* !_CRYPT_AES_H_ */
@@ -27,13 +27,27 @@
 
 #include "arpc.h"
 #include "arc4.h"
+#include "chacha20.h"
 
 class axprt_crypt : public axprt_stream {
+public:
+  enum crypt_mode { CRYPT_ARC4 = 0, CRYPT_CHACHA20_POLY1305 = 1 };
+
+private:
   enum { macsize = 16 };
 
+  crypt_mode mode;
+
   arc4 ctx_send;
   arc4 ctx_recv;
 
+  chacha20 k_send;		// CRYPT_CHACHA20_POLY1305 keys
+  chacha20 klen_send;
+  chacha20 k_recv;
+  chacha20 klen_recv;
+  u_int64_t seq_send;
+  u_int64_t seq_recv;
+
   bool cryptsend;
   bool cryptrecv;
   bool macset;
@@ -42,21 +56,33 @@ class axprt_crypt : public axprt_stream {
   u_char mackey2[16];
   u_int32_t lenpad;
 
+  bool getpkt_aead (char **, char *);
+  bool sendv_aead (const iovec *, int, u_int32_t len);
+  static void aead_setkey (chacha20 *k, chacha20 *klen,
+			   const void *key, size_t keylen);
+
 protected:
   axprt_crypt (int f, size_t ps)
-    : axprt_stream (f, ps, ps + macsize + 4),
+    : axprt_stream (f, ps, ps + macsize + 4), mode (CRYPT_ARC4),
+      seq_send (0), seq_recv (0),
       cryptsend (false), cryptrecv (false), macset (false)
     {}
   virtual ~axprt_crypt ();
   virtual bool getpkt (char **, char *);
   virtual void recvbreak ();
+  virtual bool rcvbuf_capable () const { return false; }
 
 public:
   virtual bool sendv (const iovec *, int, const sockaddr * = NULL);
+  /* Both ends must agree on the mode.  The packets on the wire are
+   * the same size either way. */
   void encrypt (const void *sendkey, size_t sendkeylen,
-		const void *recvkey, size_t recvkeylen);
-  void encrypt (const str &sendkey, const str &recvkey)
-    { encrypt (sendkey, sendkey.len (), recvkey, recvkey.len ()); }
+		const void *recvkey, size_t recvkeylen,
+		crypt_mode m = CRYPT_ARC4);
+  void encrypt (const str &sendkey, const str &recvkey,
+		crypt_mode m = CRYPT_ARC4)
+    { encrypt (sendkey, sendkey.len (), recvkey, recvkey.len (), m); }
+  crypt_mode getmode () const { return mode; }
 
   static ref<axprt_crypt> alloc (int, size_t = axprt_stream::defps);
 };
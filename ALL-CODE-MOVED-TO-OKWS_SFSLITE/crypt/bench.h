@@ -43,3 +43,18 @@ get_time ()
   __v = get_time () - __v;				\
   warn ("%s: %" U64F "d " TIME_LABEL "\n", #code, __v);	\
 }
+
+/* Like BENCH, but for code that processes nbytes per run; reports
+ * time per megabyte. */
+#define BENCH_BYTES(iter, nbytes, code)				\
+{								\
+  u_int64_t __v;						\
+  { code; }							\
+  __v = get_time ();						\
+  for (u_int i = 0; i < iter; i++) {				\
+    code;							\
+  }								\
+  __v = get_time () - __v;					\
+  warn ("%s: %" U64F "d " TIME_LABEL "/MB (%" U64F "d tot)\n",	\
+        #code, __v * 0x100000 / ((u_int64_t) (iter) * (nbytes)), __v); \
+}
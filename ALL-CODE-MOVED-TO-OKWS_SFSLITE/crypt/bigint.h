@@ -690,6 +690,32 @@ rpc_traverse (XDR *xdrs, bigint &obj, RPC_FIELD)
 
 V_RPC_TRAV_2(bigint)
 
+inline bool
+rpc_traverse (xdr_sizer &s, bigint &obj, RPC_FIELD)
+{
+  s.n += 4 + ((mpz_rawsize (&obj) + 3) & ~3);
+  return true;
+}
+inline bool
+rpc_traverse (xdr_fastenc &e, bigint &obj, RPC_FIELD)
+{
+  u_int32_t size = (mpz_rawsize (&obj) + 3) & ~3;
+  e.putint (size);
+  mpz_get_raw (e.cp, size, &obj);
+  e.cp += size;
+  return true;
+}
+inline bool
+rpc_traverse (xdr_fastdec &d, bigint &obj, RPC_FIELD)
+{
+  u_int32_t size;
+  const char *dp;
+  if (!d.getint (size) || int32_t (size) < 0 || !(dp = d.getpadbytes (size)))
+    return false;
+  mpz_set_raw (&obj, dp, size);
+  return true;
+}
+
 inline bool
 rpc_traverse (const stompcast_t, bigint &obj, RPC_FIELD)
 {
@@ -0,0 +1,82 @@
+// -*-c++-*-
+/* $Id$ */
+
+/*
+ *
+ * Copyright (C) 1998 David Mazieres (dm@uun.org)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ * USA
+ *
+ */
+
+#ifndef _CRYPT_CHACHA20_H_
+#define _CRYPT_CHACHA20_H_ 1
+
+#include "sysconf.h"
+
+/*
+ * Bernstein's ChaCha20 stream cipher, in its original form with a
+ * 64-bit nonce and a 64-bit block counter (as used by OpenSSH), and
+ * the Poly1305 one-time authenticator.
+ *
+ * Whole blocks go through a kernel picked the first time one is
+ * needed: 8 blocks at a time with AVX2, 4 with SSE2, or one at a time
+ * in portable C.
+ */
+
+class chacha20 {
+  u_int32_t key[8];
+
+public:
+  enum { keysize = 32, blocksize = 64 };
+
+  chacha20 () { bzero (key, sizeof (key)); }
+  ~chacha20 () { bzero (key, sizeof (key)); }
+  void setkey (const void *k);
+
+  /* Xors len bytes of the key stream for nonce into src, and writes
+   * them to dst (which may be src).  The key stream starts pos bytes
+   * in, so block n begins at pos 64 * n. */
+  void crypt (void *dst, const void *src, size_t len,
+	      u_int64_t nonce, u_int64_t pos = 0) const;
+
+  // Name of the kernel in use, and a way to pick another for testing.
+  static const char *impl ();
+  static bool setimpl (const char *name);
+};
+
+class poly1305 {
+  u_int32_t r[5];
+  u_int32_t h[5];
+  u_int32_t pad[4];
+  u_char buf[16];
+  size_t nbuf;
+
+  void blocks (const u_char *m, size_t len, u_int32_t hibit);
+
+public:
+  enum { keysize = 32, tagsize = 16 };
+
+  explicit poly1305 (const void *key);
+  ~poly1305 ();
+  void update (const void *m, size_t len);
+  void final (void *tag);
+};
+
+// Compares n bytes in time independent of where they differ.
+bool tagequal (const void *a, const void *b, size_t n);
+
+#endif /* !_CRYPT_CHACHA20_H_ */
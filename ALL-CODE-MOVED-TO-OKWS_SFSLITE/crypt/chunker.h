@@ -0,0 +1,96 @@
+// -*-c++-*-
+/* $Id$ */
+
+/*
+ *
+ * Copyright (C) 2000 David Mazieres (dm@uun.org)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ * USA
+ *
+ */
+
+#ifndef _CHUNKER_H_
+#define _CHUNKER_H_ 1
+
+#include "async.h"
+#include "fprint.h"
+#include "rabin_fprint.h"
+
+/*
+ * Content-defined chunking of a byte stream, in the style of FastCDC.
+ *
+ * The rolling hash is a "gear" hash, h = (h << 1) + G[byte], which
+ * costs one shift, one add and one table lookup per byte and depends
+ * only on the last 64 bytes.  The table G is seeded with the Rabin
+ * polynomial, so chunkers built with the same polynomial and sizes
+ * cut a stream at the same places.
+ *
+ * A chunk ends where the high bits of h are all zero, but never before
+ * minsize bytes and always at maxsize.  Below avgsize the test uses
+ * two more bits than log2 (avgsize), above it two fewer, which keeps
+ * chunk sizes close to avgsize.  Hashing a chunk starts 64 bytes
+ * before minsize, since earlier bytes cannot affect any hash tested.
+ *
+ * Feed data with update; the callback gets the length of each chunk
+ * as it ends, and finish ends the last one.  Chunks may span calls to
+ * update, so callers that need the bytes must keep them until the
+ * callback says where the chunk ends.
+ */
+
+class chunker : public fprint {
+public:
+  typedef callback<void, size_t>::ref cb_t;
+
+  enum { hashwindow = 64 };
+  const size_t minsize;
+  const size_t avgsize;
+  const size_t maxsize;
+
+  chunker (size_t minsize = MIN_CHUNK_SIZE, size_t avgsize = 8192,
+	   size_t maxsize = MAX_CHUNK_SIZE, u_int64_t poly = FINGERPRINT_PT);
+  void setcb (cb_t c) { cb = c; }
+
+  void update (const void *data, size_t len);
+  void updatev (const iovec *iov, u_int cnt);
+  // Scans the bytes in uio, leaving them there.
+  void update (const suio *uio) { updatev (uio->iov (), uio->iovcnt ()); }
+  void finish ();
+  void reset () { h = 0; len = 0; }
+
+  /* Returns how many of the n bytes at p belong to the current
+   * chunk.  If the chunk ends within them, sets *cut to true and
+   * starts a new chunk. */
+  size_t scan (const u_char *p, size_t n, bool *cut);
+
+  // fprint interface
+  void stop () { finish (); }
+  ptr<vec<unsigned int> > chunk_data (const unsigned char *data, size_t size);
+  ptr<vec<unsigned int> > chunk_data (suio *in_data);
+
+private:
+  u_int64_t gear[256];
+  u_int64_t gear2[256];		// gear shifted left by one
+  u_int64_t mask_s;		// mask below avgsize
+  u_int64_t mask_l;		// mask above avgsize
+  u_int64_t h;
+  size_t len;			// bytes in the current chunk
+  callback<void, size_t>::ptr cb;
+  vec<unsigned int> *out;	// collects lengths for chunk_data
+
+  void emit (size_t n);
+};
+
+#endif /* !_CHUNKER_H_ */
@@ -52,6 +52,10 @@ protected:
   void finish_le ();
   void finish_be ();
   virtual void consume (const u_char *) = 0;
+  /* Runs of whole blocks from update come here, so a hash with a
+   * multi-block kernel need not take them one at a time. */
+  virtual void consume_blocks (const u_char *p, size_t n)
+    { for (; n; n--, p += blocksize) consume (p); }
 
 public:
   void update (const void *data, size_t len);
@@ -80,11 +80,16 @@ protected:
   };
   mutable vec<precomp, 2> prevec;
 
+  friend class pkpool;
+
 public:
   esign_priv (const bigint &p, const bigint &q, u_long k);
   void precompute () const;
   size_t nprecomputed () const { return prevec.size (); }
   bigint raw_sign (const bigint &m) const;
+  // Signs without precomputation, with x random in Z_p given.  Uses
+  // no global state.
+  bigint raw_sign (const bigint &m, const bigint &x) const;
   bigint sign (const str &msg) const {
     bigint z;
     msg2bigint (&z, msg, mpz_sizeinbase2 (&n));
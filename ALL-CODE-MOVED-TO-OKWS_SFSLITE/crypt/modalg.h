@@ -108,4 +108,38 @@ public:
   }
 };
 
+/* Exponentiation with a fixed base, by Lim and Lee's comb method.  A
+ * table of the 2^h products of g^(2^(i*d)), i < h, turns g^e into d
+ * squarings and at most d multiplications for any e of up to h * d
+ * bits, about a third of the work of powm.  Building the table costs
+ * a few exponentiations, so it pays for a base used many times, such
+ * as a group generator or a long-lived public key.  Larger or negative
+ * exponents fall back to powm.  The table keeps copies of g and M, and
+ * mpz_powm uses no workspace, so threads may share one fixedbase. */
+class fixedbase {
+  bigint m;			// Modulus, M
+  bigint g;			// Base
+  u_int h;			// Rows in the comb
+  u_int d;			// Bits per row
+  vec<bigint> tab;		// tab[i] = prod of g^(2^(j*d)) for bits j of i
+
+  static void sexp (MP_INT *r, const fixedbase *t, const MP_INT *e)
+    { t->mpz_powm (r, e); }
+
+public:
+  fixedbase () : h (0), d (0) {}
+  fixedbase (const bigint &g, const bigint &m, u_int maxbits, u_int h = 8)
+    { set (g, m, maxbits, h); }
+  void set (const bigint &g, const bigint &m, u_int maxbits, u_int h = 8);
+
+  const bigint &base () const { return g; }
+  const bigint &modulus () const { return m; }
+  u_int maxbits () const { return h * d; }
+
+  /* Returns (g^e) % M */
+  void mpz_powm (MP_INT *r, const MP_INT *e) const;
+  mpdelayed<const fixedbase *, const MP_INT *> powm (const bigint &e) const
+    { return mpdelayed<const fixedbase *, const MP_INT *> (sexp, this, &e); }
+};
+
 #endif /* _MODALG_H_ */
@@ -0,0 +1,138 @@
+// -*-c++-*-
+/* $Id$ */
+
+/*
+ *
+ * Copyright (C) 1998 David Mazieres (dm@uun.org)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ * USA
+ *
+ */
+
+#ifndef _PKPOOL_H_
+#define _PKPOOL_H_ 1
+
+#include "async.h"
+#include "rpc_stats.h"
+#include "rsa.h"
+#include "rabin.h"
+#include "esign.h"
+#include "schnorr.h"
+#include "srp.h"
+
+/*
+ * A pool of threads for private-key operations, so that a burst of
+ * handshakes doesn't stall the event loop.  Each operation is split
+ * in three: whatever needs random numbers or other global state
+ * (padding, blinding values, ephemeral keys) runs on the calling loop
+ * before the operation is queued, the exponentiations run on a
+ * worker, and the result goes back to the calling loop, which calls
+ * the callback.  A worker only reads the key and works on bigints
+ * of its own, so keys may be used on the loop at the same time; but
+ * an srp_server belongs to the pool until srp_next's callback.
+ *
+ * A pool belongs to the loop that made it; only that loop may queue
+ * operations, and all callbacks run there.
+ *
+ * Threads need --enable-mtcore.  Without it, or with nthreads 0, the
+ * work runs on the loop, though callbacks still come later, never
+ * from inside the call that queued the operation.
+ *
+ * Destroying a pool with operations outstanding is an error.
+ */
+
+class pkpool {
+public:
+  // Operations of one's own: run is called on a worker, done back on
+  // the pool's loop, and then the job is deleted.
+  class job {
+  public:
+    job () : pool (NULL), wait_usec (0), run_usec (0) {}
+    virtual ~job () {}
+    virtual void run () = 0;
+    virtual void done () = 0;
+  private:
+    friend class pkpool;
+    pkpool *pool;
+    struct timespec queued;
+    u_int64_t wait_usec;
+    u_int64_t run_usec;
+  };
+
+  struct stats_t {
+    stats_t () : nqueued (0), ndone (0), depth (0), maxdepth (0) {}
+    u_int64_t nqueued;
+    u_int64_t ndone;
+    size_t depth;			// queued or running now
+    size_t maxdepth;
+    rpc_stats::histogram_t wait;	// usec from submit to start
+    rpc_stats::histogram_t run;		// usec on the worker
+  };
+
+  typedef callback<void, bigint>::ref cbbig;
+  typedef callback<void, bool, bigint, bigint>::ref cbendorse;
+  typedef callback<void, srpres>::ref cbsrp;
+
+  explicit pkpool (u_int nthreads);
+  ~pkpool ();
+
+  void submit (job *j);
+
+  // Like decrypt in rsa_priv and rabin_priv; NULL on failure.
+  void rsa_decrypt (ptr<const rsa_priv> k, const bigint &msg, size_t msglen,
+		    cbs cb);
+  void rabin_decrypt (ptr<const rabin_priv> k, const bigint &msg,
+		      size_t msglen, cbs cb);
+  // Like sign and sign_r in rabin_priv, and sign in esign_priv.
+  void rabin_sign (ptr<const rabin_priv> k, const str &msg, cbbig cb);
+  void rabin_sign_r (ptr<const rabin_priv> k, const str &msg, cbbig cb);
+  void esign_sign (ptr<const esign_priv> k, const str &msg, cbbig cb);
+  // Like schnorr_srv_priv::endorse_signature; cb gets its return
+  // value, r_srv and s_srv.
+  void schnorr_endorse (ptr<const schnorr_srv_priv> k, const str &msg,
+			const bigint &r_clnt, cbendorse cb);
+  // Like srp_server::next.  msgin is read before srp_next returns;
+  // s and msgout must stay put until cb.
+  void srp_next (ptr<srp_server> s, srpmsg *msgout, const srpmsg *msgin,
+		 cbsrp cb);
+
+  u_int nthreads () const { return _threads.size (); }
+  const stats_t &stats () const { return _stats; }
+  // Appends a one-line summary: depth, counts and wait/run percentiles.
+  void dump (strbuf &out) const;
+
+private:
+  struct worker_t;
+  struct queue_t;
+  class rsa_decrypt_job;
+  class rabin_decrypt_job;
+  class rabin_sign_job;
+  class esign_sign_job;
+  class schnorr_endorse_job;
+  class srp_next_job;
+
+  static void *worker_main (void *arg);
+  static void finished (void *arg);
+  void runinline (job *j);
+  void complete (job *j);
+
+  queue_t *_q;
+  const u_int _loop;		// where submit is called and results go
+  vec<worker_t *> _threads;
+  stats_t _stats;
+};
+
+#endif /* !_PKPOOL_H_ */
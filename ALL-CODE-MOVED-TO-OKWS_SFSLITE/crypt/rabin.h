@@ -88,6 +88,10 @@ protected:
   void init ();
 
   void D2 (bigint &, const bigint &, int rsel = 0) const;
+  // D2 with the blinding value given; uses no global state.
+  void D2 (bigint &, const bigint &, const bigint &blind, int rsel) const;
+
+  friend class pkpool;
 
 public:
   rabin_priv (const bigint &, const bigint &);
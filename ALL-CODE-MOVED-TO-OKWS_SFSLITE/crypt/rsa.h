@@ -74,6 +74,8 @@ public:
 protected:
   void init ();
 
+  friend class pkpool;
+
 public:
   rsa_priv (const bigint &, const bigint &);
   static ptr<rsa_priv> make (const bigint &n1, const bigint &n2);
@@ -8,6 +8,7 @@
 
 #include "crypt.h"
 #include "bigint.h"
+#include "modalg.h"
 #include "sha1.h"
 
 
@@ -30,6 +31,10 @@ protected:
   const bigint g;
   const bigint y;
 
+  // Tables for powers of g and y, once precompute has been called.
+  mutable ptr<const fixedbase> gpow;
+  mutable ptr<const fixedbase> ypow;
+
 protected:
   bool is_group_elem (const bigint &elem) const
   { return powm (elem, q, p) == 1; }
@@ -38,14 +43,24 @@ protected:
   { assert (log != NULL); *log = random_bigint (q.nbits () - 1); }
 
   void elem_from_log (bigint *elem, const bigint &log) const
-  { assert (elem != NULL); *elem = powm (g, log, p); }
+  { assert (elem != NULL); powg (elem, log); }
+
+  // g^e and y^e mod p, from the tables if there are any.
+  void powg (bigint *r, const bigint &e) const
+  { if (gpow) *r = gpow->powm (e); else *r = powm (g, e, p); }
+  void powy (bigint *r, const bigint &e) const
+  { if (ypow) *r = ypow->powm (e); else *r = powm (y, e, p); }
 
   void bind_r_to_m (bigint *e, const str &m, const bigint &r) const;
 
   bool check_signature (const bigint &r, const bigint &s,
 			const bigint &e, const bigint &y_v) const {
-    bigint gs (powm (g, s, p)), 
-           ye (powm (y_v, e, p));
+    bigint gs, ye;
+    powg (&gs, s);
+    if (y_v == y)
+      powy (&ye, e);
+    else
+      ye = powm (y_v, e, p);
     bigint should_be_gs (r * ye);
 
     should_be_gs %= p;
@@ -69,6 +84,19 @@ public:
   ref<schnorr_pub> clone_schnorr_pub () const 
   { return New refcounted<schnorr_pub> (p, q, g, y); }
 
+  /* Builds tables that make exponentiations of g and y about three
+   * times faster, for the price of a handful of exponentiations and
+   * 512 numbers the size of p.  Call it on keys that will sign or
+   * verify many times, and before handing a key to a pkpool. */
+  void precompute () const;
+
+  /* Checks n signatures at once, with the small-exponent test of
+   * Bellare, Garay and Rabin: returns true if every one verifies, and
+   * false, except with probability 2^-64, if any does not.  Takes a
+   * little under half the time of n calls to verify. */
+  bool batch_verify (const vec<str> &msg, const vec<bigint> &r,
+		     const vec<bigint> &s) const;
+
   bool verify (const str &msg, const bigint &r, const bigint &s) const {
     bigint e;    
 
@@ -123,8 +151,13 @@ public:
 
   bool endorse_signature (bigint *r_srv, bigint *s_srv,
 				    const str &msg, const bigint &r_clnt);
+  // With the server's ephemeral log k_srv given; uses no global state.
+  bool endorse_signature (bigint *r_srv, bigint *s_srv, const str &msg,
+			  const bigint &r_clnt, const bigint &k_srv) const;
   ptr<schnorr_srv_priv> update (const bigint &delta) const;
 
+  friend class pkpool;
+
 };
 
 class schnorr_priv : public schnorr_pub {
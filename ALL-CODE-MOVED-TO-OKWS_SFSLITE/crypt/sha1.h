@@ -28,6 +28,15 @@
 
 #include "crypthash.h"
 
+/*
+ * The compression function runs through a kernel picked the first
+ * time one is needed: the SHA extensions (SHA-NI) when the CPU has
+ * them, otherwise portable C.  transform_many runs independent
+ * states side by side, one per vector lane (8 with AVX2, 4 with
+ * SSE2), for callers such as hashcash that have many short messages
+ * rather than one long one.
+ */
+
 class sha1 : public mdblock {
 public:
   enum { hashsize = 20 };
@@ -37,7 +46,19 @@ public:
 
   static void newstate (u_int32_t state[hashwords]);
   static void transform (u_int32_t[hashwords], const u_char[blocksize]);
+  static void transform_blocks (u_int32_t[hashwords], const u_char *,
+				size_t nblocks);
+  /* Feeds blocks[i] into states[i] for each i < n.  The states must
+   * be distinct; the blocks may be anywhere. */
+  static void transform_many (u_int32_t *const *states,
+			      const u_char *const *blocks, size_t n);
   static void state2bytes (void *, const u_int32_t[hashwords]);
+
+  // Names of the kernels in use, and a way to pick others for testing.
+  static const char *impl ();
+  static bool setimpl (const char *name);
+  static const char *mbimpl ();
+  static bool setmbimpl (const char *name);
 };
 
 class sha1ctx : public sha1 {
@@ -45,6 +66,8 @@ protected:
   u_int32_t state[hashwords];
 
   void consume (const u_char *p) { transform (state, p); }
+  void consume_blocks (const u_char *p, size_t n)
+    { transform_blocks (state, p, n); }
 public:
   sha1ctx () { newstate (state); }
   void reset () { count = 0; newstate (state); }
@@ -74,6 +97,11 @@ sha1_hashv (void *digest, const iovec *iov, u_int cnt)
   sc.final (digest);
 }
 
+/* Hashes n separate messages, writing n digests back to back into
+ * digests.  Messages are hashed in parallel through transform_many. */
+void sha1_hashmany (void *digests, const void *const *msgs,
+		    const size_t *lens, size_t n);
+
 #ifdef _ARPC_XDRMISC_H_
 template<class T> bool
 sha1_hashxdr (void *digest, const T &t, bool scrub = false)
@@ -26,6 +26,7 @@
 #define _SRP_H_ 1
 
 #include "bigint.h"
+#include "modalg.h"
 #include "sha1.h"
 #include "blowfish.h"
 
@@ -53,12 +54,18 @@ protected:
   struct paramcache {
     bigint N;
     u_int iter;
-    paramcache () : iter (0) {}
+    bigint g;			// base of gpow
+    u_int nuse;			// times gpowtab was asked for g
+    ptr<const fixedbase> gpow;
+    paramcache () : iter (0), nuse (0) {}
   };
   enum { cachesize = 2 };
+  enum { gpowuses = 4 };	// build gpow once N and g are this busy
   static paramcache cache[cachesize];
   static int lastpos;
 
+  ptr<const fixedbase> gpowtab ();
+
 public:
   srp_hash sessid;
   str user;
@@ -103,15 +110,25 @@ public:
 
 class srp_server : public srp_base {
   int phase;
+  int step;			// phase next_compute is working on
+  bool Sok;
+  srp_hash Mclnt;
   bigint v;
   bigint b;
   bigint u;
+  ptr<const fixedbase> gpow;	// powers of g, if N and g are common
+
+  /* next, split so that pkpool can run the exponentiations on another
+   * thread: next_start and next_finish use global state, next_compute
+   * only this object. */
+  bool next_start (const srpmsg *msgin);
+  void next_compute ();
+  srpres next_finish (srpmsg *msgout);
 
-  srpres phase2 (srpmsg *msgout, const srpmsg *msgin);
-  srpres phase4 (srpmsg *msgout, const srpmsg *msgin);
+  friend class pkpool;
 
 public:
-  srp_server () : phase (-1) {}
+  srp_server () : phase (-1), step (-1), Sok (false) {}
   srpres init (srpmsg *msgout, const srpmsg *msgin,
 	       const srp_hash &sessid, str user, str info, int version = 6);
   srpres next (srpmsg *msgout, const srpmsg *msgin);
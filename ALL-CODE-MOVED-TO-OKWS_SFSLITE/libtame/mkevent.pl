@@ -212,6 +212,8 @@ sub do_event_impl_class ($$)
     # print the destructor
     print("  ~${CNI} () { if (!this->_cleared) clear_action (); ${del}}\n\n");
 
+    print("  TAME_RECYCLED (RECYCLE_EVENT, ${CNI})\n\n");
+
 
     # print the action functions
     print("  bool perform_action (${EVCB} *e, const char *loc, bool reuse)\n",
@@ -29,6 +29,7 @@
 #include "tame_event.h"
 #include "tame_run.h"
 #include "tame_weakref.h"
+#include "sfs_profiler.h"
 
 
 // All closures are numbered serially so that our accounting does not
@@ -159,6 +160,8 @@ private:
     ptr<C> c = _closure;
     _closure = NULL;
     if (c->block_dec_count (loc)) {
+      sfs_profiler::site_t site ("tame", c->filename (), c->lineno (),
+				 c->funcname ());
       if (tame_always_virtual ()) {
 	c->v_reenter ();
       } else {
@@ -193,12 +196,14 @@ _mkevent_implicit_rv (const ptr<C> &c,
 		      const _tame_slot_set<T1,T2,T3> &rs)
 {
 #ifdef TAME_DETEMPLATIZE
-  ptr<_event_impl<T1,T2,T3> > ret =
-    New refcounted<_event_impl<T1,T2,T3> > 
+  typedef _event_impl<T1,T2,T3> impl_t;
+  ptr<impl_t> ret =
+    TAME_NEW (RECYCLE_EVENT, impl_t) refcounted<impl_t>
     (New closure_action<C> (c), rs, loc);
 #else /* !TAME_DETEMPLATIZE */
-  ptr<_event_impl<closure_action<C>,T1,T2,T3> > ret =
-    New refcounted<_event_impl<closure_action<C>,T1,T2,T3> > 
+  typedef _event_impl<closure_action<C>,T1,T2,T3> impl_t;
+  ptr<impl_t> ret =
+    TAME_NEW (RECYCLE_EVENT, impl_t) refcounted<impl_t>
     (closure_action<C> (c), rs, loc);
 #endif /* TAME_DETEMPLATIZE */
 
@@ -11,6 +11,7 @@
 #include "vec.h"
 #include "init.h"
 #include "list.h"
+#include "sfs_select.h"
 
 template<class C>
 class container_t {
@@ -38,25 +39,34 @@ public:
   enum { defsz = 8192 };
   recycle_bin_t (size_t s = defsz) : _capacity (s), _n (0)  {}
   void expand (size_t s) { if (_capacity < s) _capacity = s; }
-  void recycle (T *obj)
+
+  // Keep obj if there's room for it, and return false if not.
+  bool push (T *obj)
+  {
+    if (_n >= _capacity)
+      return false;
+    _objects.insert_head (obj);
+    _n++;
+    return true;
+  }
+
+  T *pop ()
   {
-    if (_n < _capacity) {
-      _objects.insert_head (obj);
-      _n++;
-    } else {
-      delete obj;
+    T *o = _objects.first;
+    if (o) {
+      _objects.remove (o);
+      _n--;
     }
+    return o;
   }
 
+  void recycle (T *obj) { if (!push (obj)) delete obj; }
+
   ptr<T> get () 
   {
     ptr<T> ret;
-    if (_objects.first) {
-      T *o = _objects.first;
-      _objects.remove (o);
-      _n--;
+    if (T *o = pop ())
       ret = mkref (o);
-    }
     return ret;
   }
 
@@ -68,6 +78,77 @@ private:
 
 INIT(recycle_init);
 
+/**
+ * Typed freelists for the objects tame allocates on every call --
+ * closures and events.  The objects are constructed and destroyed as
+ * usual, but the memory of a dead one stays on its class's freelist
+ * for the next allocation.  TAME_NEW(kind, T) refcounted<T> (...)
+ * takes memory from T's freelist, and putting TAME_RECYCLED(kind, T)
+ * in a public section of class T gives T a finalize method that puts
+ * it back.  T needs refcount as a virtual base class, and should be
+ * allocated only through TAME_NEW, never subclassed.  (T's own
+ * operator new and delete would be out of reach, since refcounted<T>
+ * inherits T privately.)
+ */
+struct recycled_block_t {
+  list_entry<recycled_block_t> _lnk;
+};
+
+typedef enum { RECYCLE_CLOSURE = 0, RECYCLE_EVENT = 1 } recycle_kind_t;
+
+class recycled_pool_t {
+public:
+  enum { defsz = 1024 };
+  recycled_pool_t (recycle_kind_t k) : _bin (defsz), _kind (k), _size (0) {}
+  void *alloc (size_t n);
+  void dealloc (void *p, size_t n);
+private:
+  recycle_bin_t<recycled_block_t> _bin;
+  const recycle_kind_t _kind;
+  size_t _size;
+};
+
+// One pool per class per event loop, so threaded cores never share a
+// freelist.  A block freed on another loop's thread joins that loop's
+// pool, which is fine since blocks are plain xmalloc memory.
+template<class T> recycled_pool_t *
+recycled_pool (recycle_kind_t k)
+{
+  static SFS_TLS recycled_pool_t *pool;
+  if (!pool)
+    pool = New recycled_pool_t (k);
+  return pool;
+}
+
+inline void *
+operator new (size_t n, recycled_pool_t *pool)
+{
+  return pool->alloc (n);
+}
+
+inline void
+operator delete (void *p, recycled_pool_t *pool)
+{
+  xfree (p);
+}
+
+// Leak checkers need to see every allocation.
+#if defined (DMALLOC) || defined (SIMPLE_LEAK_CHECKER)
+# define TAME_RECYCLED(k,...)
+# define TAME_NEW(k,...) New
+#else /* !DMALLOC && !SIMPLE_LEAK_CHECKER */
+# define TAME_RECYCLED(k,...)						\
+  void finalize ()							\
+  {									\
+    typedef __VA_ARGS__ recycled_t;					\
+    void *p = dynamic_cast<void *> (this);				\
+    this->~recycled_t ();						\
+    recycled_pool<recycled_t> (k)->dealloc				\
+      (p, sizeof (refcounted<recycled_t>));				\
+  }
+# define TAME_NEW(k,...) new (recycled_pool<__VA_ARGS__ > (k))
+#endif /* !DMALLOC && !SIMPLE_LEAK_CHECKER */
+
 typedef enum { OBJ_ALIVE = 0, 
 	       OBJ_SICK = 0x1, 
 	       OBJ_DEAD = 0x2,
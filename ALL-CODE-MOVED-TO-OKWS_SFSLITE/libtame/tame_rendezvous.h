@@ -284,7 +284,7 @@ public:
       str s = b;
       tame_error (eloc, s.cstr ());
     } else {
-      ret = New refcounted<EV_IMPL_TYP>
+      ret = TAME_NEW (RECYCLE_EVENT, EV_IMPL_TYP) refcounted<EV_IMPL_TYP>
 	(NEW_ACTION my_action_t (this, cls, vs), rs, eloc);
       _n_events ++;
       _events.insert_head (ret);
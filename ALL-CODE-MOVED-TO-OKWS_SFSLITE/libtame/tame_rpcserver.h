@@ -36,6 +36,8 @@
 //
 namespace tame {
 
+  class server_factory_t;
+
   enum { VERB_NONE = 0,
 	 VERB_LOW = 10,
 	 VERB_MED = 20,
@@ -48,9 +50,12 @@ namespace tame {
     virtual void dispatch (svccb *svp) = 0;
     virtual const rpc_program &get_prog () const = 0;
     void runloop (CLOSURE);
+
+    friend class server_factory_t;
   private:
     ptr<axprt_stream> _x;
     int _verbosity;
+    server_factory_t *_factory;
   };
 
   class server_factory_t {
@@ -60,11 +65,104 @@ namespace tame {
     virtual server_t *alloc_server (int fd, int v) = 0;
     void new_connection (int fd);
     void run (const str &port, evb_t done);
-    void run (u_int port, evb_t done) { run_T (port, done); }
+    virtual void run (u_int port, evb_t done) { run_T (port, done); }
     void set_verbosity (int i) { _verbosity = i; }
+
+    friend class server_t;
+  protected:
+    // Start a server on an accepted connection.
+    void serve (int fd, const sockaddr_in &sin);
+
+    // Hooks for subclasses that keep count: a server started, got a
+    // call, or hit EOF.
+    virtual void server_started () {}
+    virtual void server_dispatched () {}
+    virtual void server_done () {}
+
+    int _verbosity;
   private:
     void run_T (u_int port, evb_t done, CLOSURE);
-    int _verbosity;
+  };
+
+  //
+  // A server_factory_t that pre-forks n worker processes, each running
+  // its own event loop, and spreads connections across them:
+  //
+  //   MP_REUSEPORT: every worker binds the port itself with SO_REUSEPORT
+  //      and the kernel balances accepts.  Falls back to MP_HANDOFF
+  //      where SO_REUSEPORT is missing.
+  //   MP_HANDOFF: the parent accepts and passes each connection over a
+  //      unix socket, as tinetd does, to the worker with the fewest
+  //      open connections.
+  //
+  // Workers that crash are restarted after a second.  SIGINT or SIGTERM
+  // to the parent drains: workers stop accepting, finish their open
+  // connections (for at most the drain timeout), and exit; then done
+  // fires.  Workers are forked from inside the event loop, so whatever
+  // the program set up before run() -- timers, fd callbacks -- is
+  // copied into each of them.
+  //
+  class mpserver_factory_t : public server_factory_t {
+  public:
+    typedef enum { MP_REUSEPORT = 0, MP_HANDOFF = 1 } mp_mode_t;
+
+    mpserver_factory_t (u_int n, mp_mode_t m = MP_REUSEPORT);
+    ~mpserver_factory_t ();
+    using server_factory_t::run;
+    void run (u_int port, evb_t done) { run_T (port, done); }
+    void set_drain_timeout (time_t t) { _drain_timeout = t; }
+
+    // Counters live in shared memory, so the parent reads what every
+    // worker is doing without asking.  Approximate.
+    struct worker_stats_t {
+      worker_stats_t () : pid (0), n_started (0), n_accepted (0),
+			  n_active (0), n_calls (0) {}
+      pid_t pid;
+      u_int64_t n_started;
+      u_int64_t n_accepted;
+      u_int64_t n_active;
+      u_int64_t n_calls;
+    };
+
+    u_int nworkers () const { return _n; }
+    worker_stats_t worker_stats (u_int i) const;
+    void dump_stats () const;
+
+    // Index of this worker, or -1 in the parent.
+    int worker_id () const { return _id; }
+
+  protected:
+    void server_started ();
+    void server_dispatched ();
+    void server_done ();
+
+  private:
+    struct slot_t;
+
+    void run_T (u_int port, evb_t done, CLOSURE);
+    bool spawn (u_int i);
+    void reaped (u_int i, int status);
+    void respawn (u_int i);
+    void handoff ();
+    u_int pick_worker ();
+
+    void worker_main (u_int i, int lfd) __attribute__ ((noreturn));
+    void worker_recvfd ();
+    void worker_drain ();
+    void worker_exit ();
+
+    const u_int _n;
+    mp_mode_t _mode;
+    time_t _drain_timeout;
+    u_int _port;
+    int _lfd;
+    int _id;
+    bool _draining;
+    u_int _nlive;
+    u_int _next;
+    slot_t *_slots;
+    vec<int> _ctlfds;
+    evv_t::ptr _all_exited;
   };
 
 };
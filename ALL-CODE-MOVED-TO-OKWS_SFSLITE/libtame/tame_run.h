@@ -69,6 +69,11 @@ public:
   void disable () { _collect = false; }
   inline void evv_rec_hit () { if (_collect) _evv_rec_hit (); }
   inline void evv_rec_miss() { if (_collect) _evv_rec_miss(); }
+  // The typed freelists of tame_recycle.h, one set of counts per kind.
+  inline void ev_pool_hit () { if (_collect) _ev_pool_hit (); }
+  inline void ev_pool_miss() { if (_collect) _ev_pool_miss(); }
+  inline void cls_pool_hit () { if (_collect) _cls_pool_hit (); }
+  inline void cls_pool_miss() { if (_collect) _cls_pool_miss(); }
   inline void mkevent_impl_rv_alloc(const char *loc)
   { if (_collect) _mkevent_impl_rv_alloc (loc); }
 
@@ -76,10 +81,20 @@ public:
   inline void did_mkclosure () { if (_collect) _did_mkclosure (); }
   inline void did_new_rv () { if (_collect) _did_new_rv (); }
 
+  // Counts so far; a miss is a trip to malloc.
+  int n_mkevent () const { return _n_mkevent; }
+  int n_mkclosure () const { return _n_mkclosure; }
+  int n_ev_pool_miss () const { return _n_ev_pool_miss; }
+  int n_cls_pool_miss () const { return _n_cls_pool_miss; }
+
 private:
 
   void _evv_rec_hit () { _n_evv_rec_hit ++; }
   void _evv_rec_miss () { _n_evv_rec_miss ++; }
+  void _ev_pool_hit () { _n_ev_pool_hit ++; }
+  void _ev_pool_miss () { _n_ev_pool_miss ++; }
+  void _cls_pool_hit () { _n_cls_pool_hit ++; }
+  void _cls_pool_miss () { _n_cls_pool_miss ++; }
   void _mkevent_impl_rv_alloc (const char *loc);
   void _did_mkevent () { _n_mkevent ++; }
   void _did_mkclosure () { _n_mkclosure ++; }
@@ -87,6 +102,8 @@ private:
 
   bool _collect;
   int _n_evv_rec_hit, _n_evv_rec_miss;
+  int _n_ev_pool_hit, _n_ev_pool_miss;
+  int _n_cls_pool_hit, _n_cls_pool_miss;
   int _n_mkevent, _n_mkclosure, _n_new_rv;
 
   qhash<const char *, int> _mkevent_impl_rv;
@@ -0,0 +1,57 @@
+// -*-c++-*-
+/* $Id$ */
+
+/*
+ *
+ * Copyright (C) 1998 David Mazieres (dm@uun.org)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ * USA
+ *
+ */
+
+//
+// RPC programs for the tests, written out by hand since the tests
+// don't run rpcc.  TEST_PROC makes an rpcgen_table entry from the
+// argument and result types, which need T_alloc and xdr_T functions;
+// TEST_PROG makes the rpc_program around a table.  echo_prog is the
+// program most of the RPC tests talk: ECHO_ECHO and ECHO_SLOW both
+// answer their argument plus one, ECHO_SLOW after a pause.
+//
+
+#ifndef _TESTS_ECHO_PROG_H_
+#define _TESTS_ECHO_PROG_H_ 1
+
+#include "arpc.h"
+
+#define TEST_PROC(name, arg, res)					\
+  { name,								\
+    &typeid (arg), arg##_alloc, xdr_##arg, NULL,			\
+    &typeid (res), res##_alloc, xdr_##res, NULL }
+
+#define TEST_PROG(progno, versno, tbl, name)				\
+  { progno, versno, tbl, sizeof (tbl) / sizeof (tbl[0]), name }
+
+enum { ECHO_NULL = 0, ECHO_ECHO = 1, ECHO_SLOW = 2 };
+
+static const rpcgen_table echo_tbl[] = {
+  TEST_PROC ("ECHO_NULL", void, void),
+  TEST_PROC ("ECHO_ECHO", u_int32_t, u_int32_t),
+  TEST_PROC ("ECHO_SLOW", u_int32_t, u_int32_t),
+};
+static const rpc_program echo_prog = TEST_PROG (0x20000fff, 1, echo_tbl,
+						"echo");
+
+#endif /* !_TESTS_ECHO_PROG_H_ */
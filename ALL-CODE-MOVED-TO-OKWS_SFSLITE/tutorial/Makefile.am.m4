@@ -104,7 +104,14 @@ tame_standalone(utf8fix)
 dnl dnl dnl dnl dnl dnl dnl dnl dnl dnl dnl dnl dnl dnl dnl dnl dnl dnl
 dnl dnl dnl dnl dnl dnl dnl dnl dnl dnl dnl dnl dnl dnl dnl dnl dnl dnl
 
-noinst_PROGRAMS = tame_exes 
+dnl
+dnl Plain C++ (no tame), since it runs on many event loops at once.
+dnl
+mtperf_SOURCES = mtperf.C ex_prot.C
+mtperf.o: ex_prot.h
+mtperf_DEPENDENCIES = $(LIBASYNC) $(LIBARPC)
+
+noinst_PROGRAMS = tame_exes mtperf
 
 RPC_AUTOGEN_FILES = ex_prot.C ex_prot.h
 